@@ -37,12 +37,15 @@
 #include <errno.h>
 #include <sched.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <signal.h>
 
 /*
  * Global variables
  */
 int ums_dev = -UMS_ERROR;                                 
 pthread_mutex_t ums_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_rwlock_t ums_workers_lock = PTHREAD_RWLOCK_INITIALIZER;
 
 ums_completion_list_t completion_lists = {
     .list = LIST_HEAD_INIT(completion_lists.list),
@@ -57,6 +60,30 @@ ums_scheduler_list_t schedulers = {
     .count = 0
 };
 __thread ums_clid_t completion_list_id;
+__thread int ums_scheduler_dev = -UMS_ERROR;
+__thread ready_ring_t *ums_ready_ring = NULL;
+const stats_page_t *ums_stats_page = NULL;
+pthread_once_t ums_preempt_handler_once = PTHREAD_ONCE_INIT;
+int ums_preempt_handler_status = -UMS_ERROR;
+struct sigaction ums_previous_preempt_action;
+
+/*
+ * Static functions
+ */
+static list_params_t *dequeue_completion_list_items(unsigned long cmd, long timeout);
+static int switch_to_worker(ums_wid_t wid, worker_status_t status, unsigned long cmd);
+static void map_ready_ring(ums_clid_t clid);
+static void unmap_ready_ring();
+static ums_wid_t pop_ready_ring();
+static void *run_standby_pthread(void *args);
+static void preempt_handler(int sig, siginfo_t *info, void *ucontext);
+static void chain_preempt_signal(int sig, siginfo_t *info, void *ucontext);
+static int install_preempt_handler();
+static void install_preempt_handler_once();
+static int enter_standby(ums_clid_t clid);
+static list_params_t *grow_list_params(ums_scheduler_t *scheduler, unsigned int worker_count);
+static ums_sid_t create_scheduler(ums_clid_t clid, void (*entry_point)(), unsigned long spin_threshold, unsigned int steal_batch);
+static ums_wid_t create_worker_thread(ums_clid_t clid, unsigned long stack_size, void (*entry_point)(void *), void *args, unsigned int flags);
 
 /** @brief Opens UMS device
  *.
@@ -100,6 +127,44 @@ int close_device()
     return UMS_SUCCESS;
 }
 
+/** @brief Opens UMS device for the scheduler pthread
+ *.
+ * Each scheduler uses its own file descriptor, so that UMS kernel module binds the scheduler to the opened file and reaches it without any lookups on the following calls
+ * The file descriptor is stored in thread-local storage, therefore no mutex is required
+ *
+ *  @return returns @c UMS_SUCCESS when succesful or @c UMS_ERROR if there are any errors 
+ */
+int open_scheduler_device()
+{
+    if(ums_scheduler_dev < 0)
+    {
+        ums_scheduler_dev = open(UMS_DEVICE, O_RDONLY);
+        if(ums_scheduler_dev < 0) 
+        {
+            printf("Error: open_scheduler_device() => Error# = %d\n", errno);
+            return -UMS_ERROR;
+        }
+    }
+    return UMS_SUCCESS;
+}
+
+/** @brief Closes UMS device of the scheduler pthread
+ *.
+ *
+ *  @return returns @c UMS_SUCCESS when succesful or @c UMS_ERROR if there are any errors 
+ */
+int close_scheduler_device()
+{
+    int ret = close(ums_scheduler_dev);
+    ums_scheduler_dev = -UMS_ERROR;
+    if(ret < 0) 
+    {
+        printf("Error: close_scheduler_device() => Error# = %d\n", errno);
+        return -UMS_ERROR;
+    }
+    return UMS_SUCCESS;
+}
+
 /** @brief Requests UMS kernel module to manage current process
  *.
  * 
@@ -146,6 +211,12 @@ int ums_exit()
                 printf("Error: ums_create_scheduler() => Error# = %d\n", errno);
                 goto out;
             }
+            ret = pthread_join(temp->standby, NULL);
+            if(ret < 0)
+            {
+                printf("Error: ums_create_scheduler() => Error# = %d\n", errno);
+                goto out;
+            }
         }
     }
 
@@ -202,9 +273,257 @@ ums_clid_t ums_create_completion_list()
     return ret;
 }
 
+/** @brief Requests UMS kernel module to set the time quantum of the completion list
+ *.
+ *  A worker thread of the completion list that runs longer than the time quantum is preempted and returned to its' scheduler, as if it called @ref ums_thread_pause()
+ *  The preemption is delivered as @c UMS_PREEMPT_SIGNAL, whose handler @ref preempt_handler() is installed here, thus the stacks of the worker threads have to fit a signal frame (see @c SIGSTKSZ)
+ *  A handler of @c UMS_PREEMPT_SIGNAL installed by the application before is still called for the signals not sent by UMS kernel module
+ *
+ *  @param clid ID of the completion list
+ *  @param quantum Time quantum in nanoseconds, 0 to disable preemption
+ *  @return returns @c UMS_SUCCESS when succesful or @c UMS_ERROR if there are any errors 
+ */
+int ums_set_completion_list_quantum(ums_clid_t clid, unsigned long quantum)
+{
+    quantum_params_t params = {
+        .clid = clid,
+        .quantum = quantum
+    };
+
+    int ret = open_device();
+    if(ret < 0)
+    {
+        printf("Error: ums_set_completion_list_quantum() => UMS_DEVICE => Error# = %d\n", errno);
+        return -UMS_ERROR;
+    }
+
+    if(quantum != 0 && install_preempt_handler() < 0)
+    {
+        return -UMS_ERROR;
+    }
+
+    ret = ioctl(ums_dev, UMS_SET_QUANTUM, (unsigned long)&params);
+    if(ret < 0)
+    {
+        printf("Error: ums_set_completion_list_quantum() => IOCTL => Error# = %d\n", errno);
+        return -UMS_ERROR;
+    }
+    return ret;
+}
+
+/** @brief Installs @ref preempt_handler() as the handler of @c UMS_PREEMPT_SIGNAL once per process
+ *.
+ *  Called when a time quantum is set and by the standby pthreads, since the signal also parks a pthread whose worker thread has returned from a blocking call
+ *
+ *  @return returns @c UMS_SUCCESS when succesful or @c UMS_ERROR if there are any errors 
+ */
+static int install_preempt_handler()
+{
+    pthread_once(&ums_preempt_handler_once, install_preempt_handler_once);
+    return ums_preempt_handler_status;
+}
+
+/** @brief Installs @ref preempt_handler(), the handler installed by the application before is kept in ums_previous_preempt_action and called by @ref chain_preempt_signal()
+ *.
+ *  The signal is not blocked while the handler runs (@c SA_NODEFER): the handler may switch the pthread to another worker thread or a scheduler,
+ *  while the signal frame holding the signal mask is restored only when the preempted worker thread returns from the handler, possibly on another pthread.
+ *
+ */
+static void install_preempt_handler_once()
+{
+    struct sigaction action = {
+        .sa_sigaction = preempt_handler,
+        .sa_flags = SA_SIGINFO | SA_RESTART | SA_NODEFER
+    };
+
+    sigemptyset(&action.sa_mask);
+    if(sigaction(UMS_PREEMPT_SIGNAL, &action, &ums_previous_preempt_action) < 0)
+    {
+        printf("Error: install_preempt_handler() => sigaction() => Error# = %d\n", errno);
+        return;
+    }
+    ums_preempt_handler_status = UMS_SUCCESS;
+}
+
+/** @brief Handler of @c UMS_PREEMPT_SIGNAL, which is sent by UMS kernel module to the pthread whose worker thread has run out of its' time quantum,
+ *  or has returned from a blocking call while its' scheduler was handed off to a standby pthread
+ *.
+ *  Runs on the stack of the worker thread and requests the UMS kernel module to preempt it. The request returns when the worker thread is executed again,
+ *  then the return from the handler restores the registers the worker thread was interrupted with from the signal frame.
+ *  The UMS kernel module ignores the request if the preemption is stale (@c UMS_PREEMPT_STALE), e.g. the worker thread has paused meanwhile.
+ *  If the signal was not sent by the UMS kernel module (@c UMS_PREEMPT_NOT_PENDING, or the pthread has no UMS device), it is passed on by @ref chain_preempt_signal().
+ *  errno is preserved, since the worker thread is interrupted at an arbitrary instruction.
+ *
+ *  @param sig @c UMS_PREEMPT_SIGNAL
+ *  @param info information about the signal
+ *  @param ucontext context the pthread was interrupted with
+ */
+static void preempt_handler(int sig, siginfo_t *info, void *ucontext)
+{
+    int saved_errno = errno;
+    int ret = UMS_PREEMPT_NOT_PENDING;
+
+    if(ums_scheduler_dev >= 0)
+    {
+        ret = ioctl(ums_scheduler_dev, UMS_THREAD_PREEMPT);
+    }
+    if(ret == UMS_PREEMPT_NOT_PENDING || ret < 0)
+    {
+        chain_preempt_signal(sig, info, ucontext);
+    }
+    errno = saved_errno;
+}
+
+/** @brief Passes @c UMS_PREEMPT_SIGNAL that was not sent by UMS kernel module on to the handler the application installed before the UMS library
+ *.
+ *  Nothing is called if there was no handler, since @c SIGURG is ignored by default
+ *
+ *  @param sig @c UMS_PREEMPT_SIGNAL
+ *  @param info information about the signal
+ *  @param ucontext context the pthread was interrupted with
+ */
+static void chain_preempt_signal(int sig, siginfo_t *info, void *ucontext)
+{
+    if(ums_previous_preempt_action.sa_flags & SA_SIGINFO)
+    {
+        ums_previous_preempt_action.sa_sigaction(sig, info, ucontext);
+    }
+    else if(ums_previous_preempt_action.sa_handler != SIG_DFL && ums_previous_preempt_action.sa_handler != SIG_IGN)
+    {
+        ums_previous_preempt_action.sa_handler(sig);
+    }
+}
+
+/** @brief Requests UMS kernel module to provide the counters of the schedulers, completion lists and worker threads of the process in binary form
+ *.
+ *  The counters are stored in @p stats, which is grown until all entries fit into it, thus it can be reused by the following calls.
+ *  Entries are ordered by their type (schedulers, completion lists, worker threads) and ID, see @ref stats_params.
+ *  Can be called by any pthread of the process, e.g. a telemetry pthread sampling the counters periodically.
+ *
+ *  @param stats pointer to @ref stats_params returned by the previous call, or @c NULL to allocate a new one
+ *  @return returns pointer to @ref stats_params that has to be released by @c free(), or @c NULL if there are any errors (@p stats is released then)
+ */
+stats_params_t *ums_get_stats(stats_params_t *stats)
+{
+    stats_params_t *temp;
+    unsigned int size = stats != NULL ? stats->size : 0;
+
+    int ret = open_device();
+    if(ret < 0)
+    {
+        printf("Error: ums_get_stats() => UMS_DEVICE => Error# = %d\n", errno);
+        free(stats);
+        return NULL;
+    }
+
+    while(1)
+    {
+        if(stats == NULL || stats->size < size)
+        {
+            temp = (stats_params_t *)realloc(stats, sizeof(stats_params_t) + size * sizeof(stats_entry_t));
+            if(temp == NULL)
+            {
+                printf("Error: ums_get_stats() => Error# = %d\n", errno);
+                free(stats);
+                return NULL;
+            }
+            stats = temp;
+        }
+        stats->version = UMS_STATS_VERSION;
+        stats->size = size;
+
+        ret = ioctl(ums_dev, UMS_GET_STATS, (unsigned long)stats);
+        if(ret < 0)
+        {
+            printf("Error: ums_get_stats() => IOCTL => Error# = %d\n", errno);
+            free(stats);
+            return NULL;
+        }
+
+        if(stats->entry_count == stats->scheduler_count + stats->completion_list_count + stats->worker_count)
+        {
+            return stats;
+        }
+        size = (stats->scheduler_count + stats->completion_list_count + stats->worker_count) * 2;
+    }
+}
+
+/** @brief Maps the page where UMS kernel module publishes the live counters of the schedulers of the process
+ *.
+ *  The page is read-only and is updated by UMS kernel module on every switch, thus the counters can be sampled without any ioctl call.
+ *  The page is mapped once per process and unmapped by @ref cleanup().
+ *
+ *  @return returns pointer to @ref stats_page, or @c NULL if there are any errors
+ */
+const stats_page_t *ums_map_stats()
+{
+    void *page;
+
+    int ret = open_device();
+    if(ret < 0)
+    {
+        printf("Error: ums_map_stats() => UMS_DEVICE => Error# = %d\n", errno);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&ums_mutex);
+    if(ums_stats_page == NULL)
+    {
+        page = mmap(NULL, sizeof(stats_page_t), PROT_READ, MAP_SHARED, ums_dev, (off_t)UMS_STATS_PAGE_PGOFF * sysconf(_SC_PAGESIZE));
+        if(page == MAP_FAILED)
+        {
+            printf("Error: ums_map_stats() => MMAP => Error# = %d\n", errno);
+        }
+        else
+        {
+            ums_stats_page = (const stats_page_t *)page;
+        }
+    }
+    pthread_mutex_unlock(&ums_mutex);
+
+    return ums_stats_page;
+}
+
+/** @brief Reads a consistent snapshot of the live counters of the scheduler with ID @p sid from the page mapped by @ref ums_map_stats()
+ *.
+ *  The counters are copied while the sequence number of the entry is even and unchanged, otherwise the copy is retried.
+ *
+ *  @param sid ID of the scheduler
+ *  @param stats pointer to the structure where the counters are copied
+ *  @return returns UMS_SUCCESS when succeeds or -UMS_ERROR if the page cannot be mapped or there is no scheduler with ID @p sid
+ */
+int ums_read_scheduler_stats(ums_sid_t sid, scheduler_live_stats_t *stats)
+{
+    const scheduler_live_stats_t *entry;
+    unsigned int sequence;
+
+    const stats_page_t *page = ums_map_stats();
+    if(page == NULL || sid >= __atomic_load_n(&page->scheduler_count, __ATOMIC_ACQUIRE))
+    {
+        return -UMS_ERROR;
+    }
+    entry = &page->schedulers[sid];
+
+    while(1)
+    {
+        sequence = __atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE);
+        if(sequence & 1)
+        {
+            continue;
+        }
+        *stats = *entry;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&entry->sequence, __ATOMIC_RELAXED) == sequence)
+        {
+            return UMS_SUCCESS;
+        }
+    }
+}
+
 /** @brief Requests UMS kernel module to create a worker thread assigned to specific comletion list
  *.
  *  Library requests UMS kernel module to create a worker thread by passing @ref worker_params
+ *  Worker threads can be added by any pthread of the process, also while the completion list is used by schedulers: the worker thread is scheduled by them as soon as it is created
  *
  *  @param clid ID of the completion list where worker thread is assigned to
  *  @param stack_size Stack size of the worker thread set by a user
@@ -213,6 +532,38 @@ ums_clid_t ums_create_completion_list()
  *  @return returns Worker ID
  */
 ums_wid_t ums_create_worker_thread(ums_clid_t clid, unsigned long stack_size, void (*entry_point)(void *), void *args)
+{
+    return create_worker_thread(clid, stack_size, entry_point, args, 0);
+}
+
+/** @brief Creates a worker thread as @ref ums_create_worker_thread() does, declaring that it never uses FPU and vector registers
+ *.
+ *  UMS kernel module does not switch FPU state for such worker threads, which makes their context switches cheaper.
+ *  The worker thread (including the functions it calls) has to be compiled without floating point and vector instructions, e.g. with @c -mgeneral-regs-only.
+ *  Violations are reported by UMS kernel module loaded with the @c debug_fpu parameter.
+ *
+ *  @param clid ID of the completion list where worker thread is assigned to
+ *  @param stack_size Stack size of the worker thread set by a user
+ *  @param entry_point Function pointer and an entry point set by a user, that serves as a starting point of the worker thread
+ *  @param args Pointer of the function arguments that are passed to the entry point/function 
+ *  @return returns Worker ID
+ */
+ums_wid_t ums_create_worker_thread_without_fpu(ums_clid_t clid, unsigned long stack_size, void (*entry_point)(void *), void *args)
+{
+    return create_worker_thread(clid, stack_size, entry_point, args, UMS_WORKER_NO_FPU);
+}
+
+/** @brief Implements @ref ums_create_worker_thread() and its' variants
+ *.
+ *
+ *  @param clid ID of the completion list where worker thread is assigned to
+ *  @param stack_size Stack size of the worker thread set by a user
+ *  @param entry_point Function pointer and an entry point set by a user, that serves as a starting point of the worker thread
+ *  @param args Pointer of the function arguments that are passed to the entry point/function 
+ *  @param flags Flags of the worker thread, e.g. @ref UMS_WORKER_NO_FPU
+ *  @return returns Worker ID
+ */
+static ums_wid_t create_worker_thread(ums_clid_t clid, unsigned long stack_size, void (*entry_point)(void *), void *args, unsigned int flags)
 {
     ums_worker_t *worker;
     ums_completion_list_node_t *comp_list;
@@ -230,6 +581,7 @@ ums_wid_t ums_create_worker_thread(ums_clid_t clid, unsigned long stack_size, vo
     params->function_args = (unsigned long)args;
     params->stack_size = stack_size < UMS_MIN_STACK_SIZE ? UMS_MIN_STACK_SIZE : stack_size;
     params->clid = clid;
+    params->flags = flags;
 
     void *stack;
     int ret = posix_memalign(&stack, 16, stack_size);
@@ -266,10 +618,13 @@ ums_wid_t ums_create_worker_thread(ums_clid_t clid, unsigned long stack_size, vo
     worker->wid = (ums_wid_t)ret;
     worker->state = IDLE;
     worker->worker_params = params;
-    list_add_tail(&(worker->list), &workers.list);
 
+    pthread_rwlock_wrlock(&ums_workers_lock);
+    list_add_tail(&(worker->list), &workers.list);
     workers.count++;
-    comp_list->worker_count++;
+    __atomic_add_fetch(&comp_list->worker_count, 1, __ATOMIC_RELEASE);
+    comp_list->state = IDLE;
+    pthread_rwlock_unlock(&ums_workers_lock);
 
     return ret;
 }
@@ -280,13 +635,62 @@ ums_wid_t ums_create_worker_thread(ums_clid_t clid, unsigned long stack_size, vo
  *  Each pthread jumps to @ref ums_enter_scheduling_mode() function and requests UMS kernel module to create a scheduler by passing @ref scheduler_params.
  *  After succesful creation of the scheduler by the UMS kernel module, created pthread becomes scheduler.
  *  It starts scheduler work by jumping to the entry point assigned by a user and stays there until @ref ums_exit_scheduling_mode() is called.
- *  Here @ref list_params is also created for the future calls of @ref ums_dequeue_completion_list_items() by a scheduler (since in this stage the completion list has been fully populated and cannot be modified later). 
+ *  Here @ref list_params is also created for the future calls of @ref ums_dequeue_completion_list_items() by a scheduler, it grows when worker threads are added to the completion list later. 
+ *  
+ *  The scheduler spins for at most @ref UMS_DEFAULT_SPIN_THRESHOLD nanoseconds in @ref ums_dequeue_completion_list_items_wait() before it sleeps.
+ *  
+ *  The scheduler runs on its' own stack of @ref UMS_SCHEDULER_STACK_SIZE bytes, and a standby pthread is created together with it.
+ *  When a worker thread blocks in the kernel, the scheduler continues on a standby pthread of the completion list, while the blocked pthread becomes a standby pthread itself.
  *  
  *  @param clid ID of the completion list that is assigned to the scheduler
  *  @param entry_point Function pointer and an entry point set by a user, that serves as a starting point of the scheduler. It is a scheduling function that determines the next thread to be scheduled
  *  @return returns Scheduler ID
  */
 ums_sid_t ums_create_scheduler(ums_clid_t clid, void (*entry_point)())
+{
+    return ums_create_scheduler_with_spin_threshold(clid, entry_point, UMS_DEFAULT_SPIN_THRESHOLD);
+}
+
+/** @brief Creates a scheduler as @ref ums_create_scheduler() does with a custom spin threshold
+ *.
+ *  The spin threshold is the maximum time the scheduler spins in @ref ums_dequeue_completion_list_items_wait() waiting for worker threads before it sleeps.
+ *  The UMS kernel module adapts the actual time within this limit, depending on how soon worker threads become available.
+ *  
+ *  @param clid ID of the completion list that is assigned to the scheduler
+ *  @param entry_point Function pointer and an entry point set by a user, that serves as a starting point of the scheduler. It is a scheduling function that determines the next thread to be scheduled
+ *  @param spin_threshold Maximum spinning time in nanoseconds, 0 to sleep right away
+ *  @return returns Scheduler ID
+ */
+ums_sid_t ums_create_scheduler_with_spin_threshold(ums_clid_t clid, void (*entry_point)(), unsigned long spin_threshold)
+{
+    return create_scheduler(clid, entry_point, spin_threshold, 0);
+}
+
+/** @brief Creates a scheduler as @ref ums_create_scheduler() does with work stealing enabled
+ *.
+ *  When the completion list of the scheduler has no idle worker threads, the scheduler takes at most @p steal_batch idle worker threads
+ *  from another completion list of the process in a dequeue call. The worker threads are moved to the completion list of the scheduler.
+ *  
+ *  @param clid ID of the completion list that is assigned to the scheduler
+ *  @param entry_point Function pointer and an entry point set by a user, that serves as a starting point of the scheduler. It is a scheduling function that determines the next thread to be scheduled
+ *  @param steal_batch Maximum number of worker threads taken at once
+ *  @return returns Scheduler ID
+ */
+ums_sid_t ums_create_scheduler_with_work_stealing(ums_clid_t clid, void (*entry_point)(), unsigned int steal_batch)
+{
+    return create_scheduler(clid, entry_point, UMS_DEFAULT_SPIN_THRESHOLD, steal_batch);
+}
+
+/** @brief Implements @ref ums_create_scheduler() and its' variants
+ *.
+ *  
+ *  @param clid ID of the completion list that is assigned to the scheduler
+ *  @param entry_point Function pointer and an entry point set by a user, that serves as a starting point of the scheduler
+ *  @param spin_threshold Maximum spinning time in nanoseconds, 0 to sleep right away
+ *  @param steal_batch Maximum number of worker threads taken at once from another completion list, 0 to disable work stealing
+ *  @return returns Scheduler ID
+ */
+static ums_sid_t create_scheduler(ums_clid_t clid, void (*entry_point)(), unsigned long spin_threshold, unsigned int steal_batch)
 {
     list_params_t *list;
     ums_completion_list_node_t *comp_list;
@@ -302,6 +706,21 @@ ums_sid_t ums_create_scheduler(ums_clid_t clid, void (*entry_point)())
     params->entry_point = (unsigned long)entry_point;
     params->clid = clid;
     params->core_id = schedulers.count;
+    params->spin_threshold = spin_threshold;
+    params->steal_batch = steal_batch;
+
+    void *stack;
+    int ret = posix_memalign(&stack, 16, UMS_SCHEDULER_STACK_SIZE);
+    if(ret != 0)
+    {
+        printf("Error: ums_create_scheduler() => Error# = %d\n", ret);
+        delete(params);
+        return -UMS_ERROR;
+    }
+
+    params->stack_addr = (unsigned long)stack + UMS_SCHEDULER_STACK_SIZE;
+    ((unsigned long *)params->stack_addr)[-1] = (unsigned long)&ums_exit_scheduling_mode;
+    params->stack_addr -= 8;
 
     ums_scheduler_t *scheduler;
     scheduler = init(ums_scheduler_t);
@@ -312,15 +731,25 @@ ums_sid_t ums_create_scheduler(ums_clid_t clid, void (*entry_point)())
     list = create_list_params(comp_list->worker_count);
     scheduler->list_params = list;
     list->size = comp_list->worker_count;
+    list->worker_count = 0;
+    list->state = IDLE;
 
 
-    int ret = pthread_create(&scheduler->tid, NULL, ums_enter_scheduling_mode, (void *)scheduler->sched_params);
+    ret = pthread_create(&scheduler->tid, NULL, ums_enter_scheduling_mode, (void *)scheduler->sched_params);
     if(ret < 0)
     {
         printf("Error: ums_create_scheduler() => pthread_create() => Error# = %d\n", errno);
         delete(params);
         return -UMS_ERROR;
     }
+    scheduler->host = scheduler->tid;
+
+    ret = pthread_create(&scheduler->standby, NULL, run_standby_pthread, (void *)(unsigned long)clid);
+    if(ret < 0)
+    {
+        printf("Error: ums_create_scheduler() => pthread_create() => Error# = %d\n", errno);
+        return -UMS_ERROR;
+    }
 
     return ret;
 }
@@ -328,6 +757,9 @@ ums_sid_t ums_create_scheduler(ums_clid_t clid, void (*entry_point)())
 /** @brief Actual function that is called by a pthread to request the UMS kernel module in order create a scheduler and assign a completion list to it
  *.
  *  Additionally assigns a CPU core on which the scheduler will operate based on available cores
+ *  The pthread opens its own UMS device via @ref open_scheduler_device(), which is closed when the scheduler exits the scheduling mode
+ *  The ring of worker threads that became available of the completion list is mapped via @ref map_ready_ring() for the dequeue calls of the scheduler
+ *  If a worker thread run by the pthread blocks in the kernel, the call returns @c UMS_HOST_PARKED and the pthread becomes a standby pthread via @ref enter_standby()
  *  
  *  @param args Pointer to @ref scheduler_params that is passed in order to create a scheduler
  *  @return 
@@ -350,39 +782,51 @@ void *ums_enter_scheduling_mode(void *args)
         pthread_exit(NULL);
     }
     
-    ret = open_device();
+    ret = open_scheduler_device();
     if(ret < 0)
     {
         printf("Error: ums_enter_scheduling_mode() => UMS_DEVICE => Error# = %d\n", errno);
         pthread_exit(NULL);
     }
 
-    ret = ioctl(ums_dev, UMS_ENTER_SCHEDULING_MODE, (unsigned long)params);
+    map_ready_ring(params->clid);
+
+    ret = ioctl(ums_scheduler_dev, UMS_ENTER_SCHEDULING_MODE, (unsigned long)params);
     if(ret < 0)
     {
         printf("Error: ums_enter_scheduling_mode() => IOCTL => Error# = %d\n", errno);
+        unmap_ready_ring();
+        close_scheduler_device();
         pthread_exit(NULL);
     }
 
+    if(ret == UMS_HOST_PARKED)
+    {
+        enter_standby(params->clid);
+    }
+
+    unmap_ready_ring();
+    close_scheduler_device();
     pthread_exit(NULL);
 }
 
 /** @brief Called by a scheduler to signal the UMS kernel module about the completion of scheduling mode
  *.
- *  Restores instruction, stack and base pointers to return back to @ref ums_enter_scheduling_mode() function to perform pthread_exit()
+ *  Restores instruction, stack and base pointers to return back to @ref ums_enter_scheduling_mode() function (or @ref enter_standby() if the scheduler was handed off to a standby pthread) to perform pthread_exit()
+ *  The function is also the return address of the scheduler entry point
  * 
  *  @return 
  */
 int ums_exit_scheduling_mode()
 {
-    int ret = open_device();
+    int ret = open_scheduler_device();
     if(ret < 0)
     {
         printf("Error: ums_exit_scheduling_mode() => UMS_DEVICE => Error# = %d\n", errno);
         return -UMS_ERROR;
     }
 
-    ret = ioctl(ums_dev, UMS_EXIT_SCHEDULING_MODE);
+    ret = ioctl(ums_scheduler_dev, UMS_EXIT_SCHEDULING_MODE);
     if(ret < 0)
     {
         printf("Error: ums_exit_scheduling_mode() => IOCTL => Error# = %d\n", errno);
@@ -437,7 +881,7 @@ int ums_execute_thread(ums_wid_t wid)
         goto out;
     }
 
-    ret = open_device();
+    ret = open_scheduler_device();
     if(ret < 0)
     {
         printf("Error: ums_execute_thread() => UMS_DEVICE => Error# = %d\n", errno);
@@ -446,13 +890,24 @@ int ums_execute_thread(ums_wid_t wid)
 
     scheduler->wid = wid;
     worker->state = RUNNING;
-    ret = ioctl(ums_dev, UMS_EXECUTE_THREAD, (unsigned long)wid);
+    ret = ioctl(ums_scheduler_dev, UMS_EXECUTE_THREAD, (unsigned long)wid);
     if(ret < 0)
     {
         printf("Error: ums_execute_thread() => IOCTL => Error# = %d\n", errno);
         return -UMS_ERROR;
     }   
 
+    worker = check_if_worker_exists(scheduler->wid);
+    if(worker != NULL && worker->state == RUNNING)
+    {
+        worker->state = IDLE;
+    }
+    if(ret == UMS_WORKER_BLOCKED)
+    {
+        scheduler->host = pthread_self();
+        ret = UMS_SUCCESS;
+    }
+
 
     out:
     return ret;
@@ -464,6 +919,9 @@ int ums_execute_thread(ums_wid_t wid)
  *   - Remove the worker thread from the list of worker threads that can be scheduled, thus completes the execution; 
  *   - Push it back to the list of available worker thread, thus pauses its' execution and can be rescheduled later.
  *  
+ *  If the worker thread has blocked in the kernel, its' scheduler was taken over by a standby pthread, while the worker thread continues on the pthread that ran it.
+ *  The request is issued anyway in that case, the UMS kernel module returns the worker thread to the completion list and the pthread becomes a standby pthread.
+ *  
  *  @param status defines the status of the execution flow of the worker thread (passing @c PAUSE will pause the execution, when @c FINISH will complete it)
  *  @return 
  */
@@ -473,29 +931,26 @@ int ums_thread_yield(worker_status_t status)
     ums_worker_t *worker;
 
     scheduler = check_if_scheduler_exists();
-    if(scheduler == NULL)
+    if(scheduler != NULL)
     {
-        printf("Error: ums_thread_yield() => Scheduler for pthread: %ld does not exist.\n", pthread_self());
-        return -UMS_ERROR;
-    }
+        worker = check_if_worker_exists(scheduler->wid);
+        if(worker == NULL)
+        {
+            printf("Error: ums_thread_yield() => Worker thread:%d was not found!\n", (int)scheduler->wid);
+            return -UMS_ERROR;
+        }
 
-    worker = check_if_worker_exists(scheduler->wid);
-    if(worker == NULL)
-    {
-        printf("Error: ums_thread_yield() => Worker thread:%d was not found!\n", (int)scheduler->wid);
-        return -UMS_ERROR;
+        worker->state = (status == PAUSE) ? IDLE : FINISHED;
     }
 
-    worker->state = (status == PAUSE) ? IDLE : FINISHED;
-
-    int ret = open_device();
+    int ret = open_scheduler_device();
     if(ret < 0)
     {
         printf("Error: ums_thread_yield() => UMS_DEVICE => Error# = %d\n", errno);
         return -UMS_ERROR;
     }
 
-    ret = ioctl(ums_dev, UMS_THREAD_YIELD, (unsigned long)status);
+    ret = ioctl(ums_scheduler_dev, UMS_THREAD_YIELD, (unsigned long)status);
     if(ret < 0)
     {
         printf("Error: ums_thread_yield() => IOCTL => Error# = %d\n", errno);
@@ -527,6 +982,121 @@ int ums_thread_exit()
     return ums_thread_yield(FINISH);
 }
 
+/** @brief Called by a worker thread to pause the execution and switch directly to the worker thread with specific ID
+ *.
+ *  Combines @ref ums_thread_pause() and @ref ums_execute_thread() in a single request to the UMS kernel module, thus the scheduler is not entered in between.
+ *  If the worker thread cannot be switched to, the calling worker thread continues its' execution and the error is returned.
+ *  
+ *  @param wid ID of the worker thread to switch to
+ *  @return 
+ */
+int ums_switch_to(ums_wid_t wid)
+{
+    return switch_to_worker(wid, PAUSE, UMS_SWITCH_TO);
+}
+
+/** @brief Called by a worker thread to pause or complete the execution and name the next worker thread to be executed (directed yield)
+ *.
+ *  Works as @ref ums_thread_yield(), but the UMS kernel module switches directly to the worker thread with specific ID.
+ *  If that worker thread cannot be switched to, the control is returned to the scheduler as @ref ums_thread_yield() does.
+ *  
+ *  @param wid ID of the worker thread to switch to
+ *  @param status defines the status of the execution flow of the worker thread (passing @c PAUSE will pause the execution, when @c FINISH will complete it)
+ *  @return 
+ */
+int ums_thread_yield_to(ums_wid_t wid, worker_status_t status)
+{
+    return switch_to_worker(wid, status, UMS_THREAD_YIELD_TO);
+}
+
+/** @brief Performs a switch request issued by @ref ums_switch_to() or @ref ums_thread_yield_to()
+ *.
+ *  The worker thread that is switched to is assigned to the scheduler before the request, since the request returns in its' context.
+ *  Its' state is not changed, since the UMS kernel module may not be able to switch to it.
+ *  If the calling worker thread has blocked in the kernel and its' scheduler was taken over, the request is issued without the bookkeeping of the scheduler as @ref ums_thread_yield() does.
+ *  
+ *  @param wid ID of the worker thread to switch to
+ *  @param status defines the status of the execution flow of the calling worker thread
+ *  @param cmd ioctl command of the request
+ *  @return 
+ */
+static int switch_to_worker(ums_wid_t wid, worker_status_t status, unsigned long cmd)
+{
+    ums_scheduler_t *scheduler;
+    ums_worker_t *worker;
+    list_params_t *list;
+
+    if(check_if_worker_exists(wid) == NULL)
+    {
+        printf("Error: switch_to_worker() => Worker thread:%d was not found!\n", (int)wid);
+        return -UMS_ERROR;
+    }
+
+    scheduler = check_if_scheduler_exists();
+    worker = NULL;
+    if(scheduler != NULL)
+    {
+        worker = check_if_worker_exists(scheduler->wid);
+        if(worker == NULL)
+        {
+            printf("Error: switch_to_worker() => Worker thread:%d was not found!\n", (int)scheduler->wid);
+            return -UMS_ERROR;
+        }
+
+        list = scheduler->list_params;
+        if(list != NULL)
+        {
+            int index = 0;
+            while(index < list->size && list->workers[index] != wid)
+            {
+                ++index;
+            }
+            if(index < list->size)
+            {
+                list->workers[index] = -1;
+                list->worker_count--;
+            }
+        }
+    }
+
+    int ret = open_scheduler_device();
+    if(ret < 0)
+    {
+        printf("Error: switch_to_worker() => UMS_DEVICE => Error# = %d\n", errno);
+        return -UMS_ERROR;
+    }
+
+    switch_params_t params;
+    params.wid = wid;
+    params.status = status;
+
+    if(worker != NULL)
+    {
+        worker->state = (status == PAUSE) ? IDLE : FINISHED;
+        scheduler->wid = wid;
+    }
+    if(cmd == UMS_SWITCH_TO)
+    {
+        ret = ioctl(ums_scheduler_dev, cmd, (unsigned long)wid);
+    }
+    else
+    {
+        ret = ioctl(ums_scheduler_dev, cmd, (unsigned long)&params);
+    }
+    if(ret < 0)
+    {
+        printf("Error: switch_to_worker() => IOCTL => Error# = %d\n", errno);
+        if(worker != NULL)
+        {
+            worker->state = RUNNING;
+            scheduler->wid = worker->wid;
+        }
+        return -UMS_ERROR;
+    }   
+
+    return ret;
+}
+
 /** @brief Called by a scheduler to request UMS kernel module to provide a list of available worker threads that can be scheduled
  *.
  *  The function passes a global @ref list_params from the @ref ums_completion_list_node structure to the UMS kernel module
@@ -537,6 +1107,32 @@ int ums_thread_exit()
  *  @return returns the pointer to a shared @ref list_params structure which contains an array of available workers that can be scheduled
  */
 list_params_t *ums_dequeue_completion_list_items()
+{
+    return dequeue_completion_list_items(UMS_DEQUEUE_COMPLETION_LIST_ITEMS, 0);
+}
+
+/** @brief Called by a scheduler to request UMS kernel module to provide a list of available worker threads, waiting for them if there are none
+ *.
+ *  Works as @ref ums_dequeue_completion_list_items(), but instead of returning an empty list the UMS kernel module parks the scheduler until a worker thread is paused,
+ *  the completion list is finished or @p timeout expires. Thus the scheduler does not have to poll the completion list in a loop.
+ * 
+ *  @param timeout Time in milliseconds to wait for available worker threads, @ref UMS_WAIT_INFINITE to wait without a timeout
+ *  @return returns the pointer to a shared @ref list_params structure which contains an array of available workers that can be scheduled (empty if the timeout has expired)
+ */
+list_params_t *ums_dequeue_completion_list_items_wait(long timeout)
+{
+    return dequeue_completion_list_items(UMS_DEQUEUE_COMPLETION_LIST_ITEMS_WAIT, timeout);
+}
+
+/** @brief Performs a dequeue request issued by @ref ums_dequeue_completion_list_items() or @ref ums_dequeue_completion_list_items_wait()
+ *.
+ *  A worker thread is taken from the ring mapped by @ref map_ready_ring() first, the UMS kernel module is requested only when the ring is empty.
+ * 
+ *  @param cmd ioctl command of the request
+ *  @param timeout Time in milliseconds to wait for available worker threads, used by blocking requests only
+ *  @return returns the pointer to a shared @ref list_params structure which contains an array of available workers that can be scheduled
+ */
+static list_params_t *dequeue_completion_list_items(unsigned long cmd, long timeout)
 {
     list_params_t *list;
     ums_scheduler_t *scheduler;
@@ -559,11 +1155,10 @@ list_params_t *ums_dequeue_completion_list_items()
     int ret;
     list = scheduler->list_params;
     
-    if(list->worker_count == 0 && comp_list->state != FINISHED)
+    if(list->worker_count == 0 && (comp_list->state != FINISHED || scheduler->sched_params->steal_batch != 0))
     { 
       
-        printf("Updating the list %ld\n", pthread_self());
-        goto dequeue;
+        goto ring;
     }
     else
     {
@@ -574,15 +1169,40 @@ list_params_t *ums_dequeue_completion_list_items()
         goto out;
     }
     
-    dequeue: ;
-    ret = open_device();
+    ring: ;
+    if(list->size < __atomic_load_n(&comp_list->worker_count, __ATOMIC_ACQUIRE) || list->size == 0)
+    {
+        list = grow_list_params(scheduler, __atomic_load_n(&comp_list->worker_count, __ATOMIC_ACQUIRE));
+    }
+
+    if(ums_ready_ring != NULL && list->size != 0)
+    {
+        if(scheduler->sched_params->steal_batch == 0 && __atomic_load_n(&ums_ready_ring->finished_count, __ATOMIC_ACQUIRE) == __atomic_load_n(&ums_ready_ring->worker_count, __ATOMIC_ACQUIRE))
+        {
+            list->state = FINISHED;
+            comp_list->state = FINISHED;
+            goto out;
+        }
+
+        ums_wid_t wid = pop_ready_ring();
+        if(wid != -1)
+        {
+            list->workers[0] = wid;
+            list->worker_count = 1;
+            list->state = IDLE;
+            goto out;
+        }
+    }
+
+    ret = open_scheduler_device();
     if(ret < 0)
     {
         printf("Error: ums_dequeue_completion_list_items() => UMS_DEVICE => Error# = %d\n", errno);
         return -UMS_ERROR;
     }
 
-    ret = ioctl(ums_dev, UMS_DEQUEUE_COMPLETION_LIST_ITEMS, (unsigned long)list);
+    list->timeout = timeout;
+    ret = ioctl(ums_scheduler_dev, cmd, (unsigned long)list);
     if(ret < 0)
     {
         printf("Error: ums_dequeue_completion_list_items() => IOCTL => Error# = %d\n", errno);
@@ -598,6 +1218,41 @@ list_params_t *ums_dequeue_completion_list_items()
     return list;
 }
 
+/** @brief Grows @ref list_params of the @p scheduler, so that it can hold @p worker_count worker threads
+ *.
+ *  Worker threads can be added to the completion list while it is used by the scheduler, thus the list grows at least twice at once to avoid reallocation on every dequeue call.
+ *  If the reallocation fails, the list keeps its' size and dequeue calls return at most list_params::size worker threads.
+ *  
+ *  @param scheduler pointer to @ref ums_scheduler
+ *  @param worker_count number of worker threads of the completion list
+ *  @return returns pointer to @ref list_params of the scheduler
+ */
+static list_params_t *grow_list_params(ums_scheduler_t *scheduler, unsigned int worker_count)
+{
+    list_params_t *list = scheduler->list_params;
+    unsigned int size = list->size * 2 > worker_count ? list->size * 2 : worker_count;
+
+    if(size == 0)
+    {
+        size = 1;
+    }
+
+    list = (list_params_t *)realloc(list, sizeof(list_params_t) + size * sizeof(ums_wid_t));
+    if(list == NULL)
+    {
+        printf("Error: grow_list_params() => Error# = %d\n", errno);
+        return scheduler->list_params;
+    }
+
+    for(unsigned int i = list->size; i < size; ++i)
+    {
+        list->workers[i] = -1;
+    }
+    list->size = size;
+    scheduler->list_params = list;
+    return list;
+}
+
 /** @brief Called by a scheduler, after performing @ref ums_dequeue_completion_list_items(), to find a next available worker thread from the completion list
  *.
  *  This function always has to be run after calling @ref ums_dequeue_completion_list_items(), since it will populate the list in the correct way to be processed 
@@ -634,6 +1289,116 @@ ums_wid_t ums_get_next_worker_thread(list_params_t *list)
     return list->workers[index];
 }
 
+/** @brief Maps the ring of worker threads that became available of the completion list with ID @p clid
+ *.
+ *  The ring is shared by the UMS kernel module, thus the scheduler can find the next worker thread without any ioctl call.
+ *  If the ring cannot be mapped, dequeue calls are performed via ioctl only.
+ *  
+ *  @param clid ID of the completion list that is assigned to the scheduler
+ */
+static void map_ready_ring(ums_clid_t clid)
+{
+    void *ring = mmap(NULL, sizeof(ready_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, ums_scheduler_dev, (off_t)clid * sysconf(_SC_PAGESIZE));
+    if(ring == MAP_FAILED)
+    {
+        printf("Error: map_ready_ring() => MMAP => Error# = %d\n", errno);
+        return;
+    }
+    ums_ready_ring = (ready_ring_t *)ring;
+}
+
+/** @brief Unmaps the ring mapped by @ref map_ready_ring()
+ *.
+ */
+static void unmap_ready_ring()
+{
+    if(ums_ready_ring != NULL)
+    {
+        munmap(ums_ready_ring, sizeof(ready_ring_t));
+        ums_ready_ring = NULL;
+    }
+}
+
+/** @brief Consumes the next entry of the ring mapped by @ref map_ready_ring()
+ *.
+ *  Schedulers sharing the completion list compete for the entries, thus the head of the ring is advanced with compare-and-swap
+ *  
+ *  @return returns ID of the worker thread that became available or -1 if the ring is empty
+ */
+static ums_wid_t pop_ready_ring()
+{
+    unsigned int head = __atomic_load_n(&ums_ready_ring->head, __ATOMIC_ACQUIRE);
+
+    while(head != __atomic_load_n(&ums_ready_ring->tail, __ATOMIC_ACQUIRE))
+    {
+        ums_wid_t wid = ums_ready_ring->wids[head & (UMS_READY_RING_SLOTS - 1)];
+        if(__atomic_compare_exchange_n(&ums_ready_ring->head, &head, head + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            return wid;
+        }
+    }
+    return -1;
+}
+
+/** @brief Function of the standby pthread created together with the scheduler of the completion list with ID passed in @p args
+ *.
+ *  The pthread opens its own UMS device and maps the ring of the completion list, since it can take over any scheduler of the completion list via @ref enter_standby()
+ *  Installs @ref preempt_handler(), which parks a pthread whose worker thread returns from a blocking call, thus the stacks of the worker threads have to fit a signal frame
+ *  
+ *  @param args ID of the completion list
+ *  @return 
+ */
+static void *run_standby_pthread(void *args)
+{
+    ums_clid_t clid = (ums_clid_t)(unsigned long)args;
+    completion_list_id = clid;
+
+    int ret = open_scheduler_device();
+    if(ret < 0)
+    {
+        printf("Error: run_standby_pthread() => UMS_DEVICE => Error# = %d\n", errno);
+        pthread_exit(NULL);
+    }
+    if(install_preempt_handler() < 0)
+    {
+        close_scheduler_device();
+        pthread_exit(NULL);
+    }
+
+    map_ready_ring(clid);
+    enter_standby(clid);
+    unmap_ready_ring();
+    close_scheduler_device();
+    pthread_exit(NULL);
+}
+
+/** @brief Waits until a scheduler of the completion list with ID @p clid is handed off to the pthread
+ *.
+ *  The call of the scheduler that executed the blocked worker thread returns in the pthread, thus this function returns only when:
+ *   - the scheduler exits the scheduling mode via @ref ums_exit_scheduling_mode()
+ *   - all worker threads of the completion list have finished
+ *  If the worker thread run by the pthread blocks in the kernel, the pthread returns here with @c UMS_HOST_PARKED and waits again.
+ *  
+ *  @param clid ID of the completion list
+ *  @return returns @c UMS_SUCCESS when succesful or @c UMS_ERROR if there are any errors 
+ */
+static int enter_standby(ums_clid_t clid)
+{
+    int ret;
+
+    do
+    {
+        ret = ioctl(ums_scheduler_dev, UMS_ENTER_STANDBY, (unsigned long)clid);
+    } while(ret == UMS_HOST_PARKED || (ret < 0 && errno == EINTR));
+
+    if(ret < 0)
+    {
+        printf("Error: enter_standby() => IOCTL => Error# = %d\n", errno);
+        return -UMS_ERROR;
+    }
+    return UMS_SUCCESS;
+}
+
 /** @brief Performs a cleanup by deleting all the data structures allocated by the library
  *.
  *  @return returns @c UMS_SUCCESS when succesful or @c UMS_ERROR if there are any errors 
@@ -673,11 +1438,17 @@ int cleanup()
         {
             list_del(&temp->list);
             printf("UMS_LIB: Scheduler:%d  was deleted.\n", temp->sched_params->sid);
+            if(temp->sched_params != NULL && temp->sched_params->stack_addr != 0) delete((void*)(temp->sched_params->stack_addr + 8 - UMS_SCHEDULER_STACK_SIZE));
             if(temp->sched_params != NULL) delete(temp->sched_params);
             if(temp->list_params != NULL) delete(temp->list_params);
             delete(temp);
         }
     }
+    if(ums_stats_page != NULL)
+    {
+        munmap((void *)ums_stats_page, sizeof(stats_page_t));
+        ums_stats_page = NULL;
+    }
     return UMS_SUCCESS;
 }
 
@@ -718,6 +1489,7 @@ ums_worker_t *check_if_worker_exists(ums_wid_t wid)
 {
     ums_worker_t *worker = NULL;
 
+    pthread_rwlock_rdlock(&ums_workers_lock);
     if(!list_empty(&workers.list))
     {
         ums_worker_t *temp = NULL;
@@ -731,6 +1503,7 @@ ums_worker_t *check_if_worker_exists(ums_wid_t wid)
             }
         }
     }
+    pthread_rwlock_unlock(&ums_workers_lock);
   
     return worker;
 }
@@ -742,7 +1515,7 @@ ums_worker_t *check_if_worker_exists(ums_wid_t wid)
  */
 ums_scheduler_t *check_if_scheduler_exists()
 {
-    ums_scheduler_t *scheduler;
+    ums_scheduler_t *scheduler = NULL;
 
     if(!list_empty(&completion_lists.list))
     {
@@ -750,7 +1523,7 @@ ums_scheduler_t *check_if_scheduler_exists()
         ums_scheduler_t *safe_temp = NULL;
         list_for_each_entry_safe(temp, safe_temp, &schedulers.list, list) 
         {
-            if(pthread_equal(temp->tid, pthread_self()))
+            if(pthread_equal(temp->host, pthread_self()))
             {
                 scheduler = temp;
                 break;
@@ -45,19 +45,31 @@ int ums_enter();
 int ums_exit();
 
 ums_clid_t ums_create_completion_list();
+int ums_set_completion_list_quantum(ums_clid_t clid, unsigned long quantum);
+stats_params_t *ums_get_stats(stats_params_t *stats);
+const stats_page_t *ums_map_stats();
+int ums_read_scheduler_stats(ums_sid_t sid, scheduler_live_stats_t *stats);
 ums_wid_t ums_create_worker_thread(ums_clid_t clid, unsigned long stack_size, void (*entry_point)(void *), void *args);
+ums_wid_t ums_create_worker_thread_without_fpu(ums_clid_t clid, unsigned long stack_size, void (*entry_point)(void *), void *args);
 ums_sid_t ums_create_scheduler(ums_clid_t clid, void (*entry_point)(void *));
+ums_sid_t ums_create_scheduler_with_spin_threshold(ums_clid_t clid, void (*entry_point)(void *), unsigned long spin_threshold);
+ums_sid_t ums_create_scheduler_with_work_stealing(ums_clid_t clid, void (*entry_point)(void *), unsigned int steal_batch);
 void *ums_enter_scheduling_mode(void *args);
 int ums_exit_scheduling_mode();
 int ums_execute_thread(ums_wid_t wid);
 int ums_thread_yield();
 int ums_thread_pause();
 int ums_thread_exit();
+int ums_switch_to(ums_wid_t wid);
+int ums_thread_yield_to(ums_wid_t wid, worker_status_t status);
 list_params_t *ums_dequeue_completion_list_items();
+list_params_t *ums_dequeue_completion_list_items_wait(long timeout);
 ums_wid_t ums_get_next_worker_thread(list_params_t *list);
 
 int open_device();
 int close_device();
+int open_scheduler_device();
+int close_scheduler_device();
 int cleanup();
 ums_completion_list_node_t *check_if_completion_list_exists(ums_clid_t clid);
 ums_worker_t *check_if_worker_exists(ums_wid_t wid);
@@ -119,7 +131,9 @@ typedef struct ums_scheduler_list {
  */
 typedef struct ums_scheduler {
     struct list_head list;                          
-    pthread_t tid;                                  /**< Pthread ID */
+    pthread_t tid;                                  /**< ID of the pthread that created the scheduler */
+    pthread_t host;                                 /**< ID of the pthread that currently runs the scheduler, it changes when the scheduler is handed off to a standby pthread */
+    pthread_t standby;                              /**< ID of the standby pthread created together with the scheduler */
     ums_wid_t wid;                                  /**< Worker thread ID */
     scheduler_params_t *sched_params;               /**< Parameters that are passed in order to create a scheduler @ref scheduler_params */
     list_params_t *list_params;                     /**< Parameters that are created by the scheduler and passed to dequeue the completion list items @ref list_params */
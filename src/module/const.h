@@ -40,6 +40,15 @@
 #define UMS_PROC_NAME_LOG   "/proc/ums: "
 #define UMS_MINOR MISC_DYNAMIC_MINOR
 #define UMS_BUFFER_LEN       64
+#define UMS_PROCESS_HASH_BITS 8
+#define UMS_HOST_HASH_BITS    8
+#define UMS_MIN_SPIN_THRESHOLD  1000
+#define UMS_MIN_QUANTUM         10000
+#define UMS_PARK_DELAY          20000
+#define UMS_LATENCY_BUCKETS     32
+#define UMS_RATE_INTERVAL       1000000000ULL
+#define UMS_RATE_WEIGHT_SHIFT   3
+#define UMS_RATE_SCALE          1000
 
 /*
  * IOCTL definitions
@@ -53,12 +62,23 @@
 #define UMS_EXECUTE_THREAD                  _IOW(UMS_IOC_MAGIC, 7, unsigned long)
 #define UMS_THREAD_YIELD                    _IOW(UMS_IOC_MAGIC, 8, unsigned long)
 #define UMS_DEQUEUE_COMPLETION_LIST_ITEMS   _IOWR(UMS_IOC_MAGIC, 9, unsigned long)
+#define UMS_DEQUEUE_COMPLETION_LIST_ITEMS_WAIT  _IOWR(UMS_IOC_MAGIC, 10, unsigned long)
+#define UMS_SWITCH_TO                       _IOW(UMS_IOC_MAGIC, 11, unsigned long)
+#define UMS_THREAD_YIELD_TO                 _IOW(UMS_IOC_MAGIC, 12, unsigned long)
+#define UMS_ENTER_STANDBY                   _IOW(UMS_IOC_MAGIC, 13, unsigned long)
+#define UMS_SET_QUANTUM                     _IOW(UMS_IOC_MAGIC, 14, unsigned long)
+#define UMS_GET_STATS                       _IOWR(UMS_IOC_MAGIC, 15, unsigned long)
+#define UMS_THREAD_PREEMPT                  _IO(UMS_IOC_MAGIC, 16)
 
 /*
  * Errors and return values
  */
 #define UMS_SUCCESS                                                     0                                           ///< Succesful execution
 #define UMS_ERROR                                                       1                                           ///< Error
+#define UMS_WORKER_BLOCKED                                              2                                           ///< The worker thread run by the scheduler has blocked in the kernel, thus the scheduler continues on a standby pthread
+#define UMS_HOST_PARKED                                                 3                                           ///< The worker thread run by the pthread has blocked in the kernel, thus the pthread has to become a standby pthread
+#define UMS_PREEMPT_STALE                                               4                                           ///< The preemption signalled by UMS kernel module is stale, e.g. the worker thread has switched meanwhile, thus it is dropped
+#define UMS_PREEMPT_NOT_PENDING                                         5                                           ///< No preemption is signalled to the pthread by UMS kernel module, thus @c UMS_PREEMPT_SIGNAL was sent by someone else
 #define UMS_ERROR_PROCESS_NOT_FOUND                                     1000                                        ///< Process is not managed by UMS kernel module
 #define UMS_ERROR_PROCESS_ALREADY_EXISTS                                1001                                        ///< Process is already managed by UMS kernel module
 #define UMS_ERROR_COMPLETION_LIST_NOT_FOUND                             1002                                        ///< Completion list cannot be found
@@ -77,6 +97,31 @@
 #define UMS_ERROR_FAILED_TO_PROC_OPEN                                   1015                                        ///< Failed to open proc entry
 #define UMS_ERROR_COMPLETION_LIST_IS_USED_AND_CANNOT_BE_MODIFIED        1016                                        ///< The completion list is being used, thus cannot be modified
 
+/** @brief Timeout of the blocking dequeue call that waits until there are available worker threads or the completion list is finished
+ *.
+ *
+ */
+#define UMS_WAIT_INFINITE                                               -1
+
+/** @brief Default time in nanoseconds the scheduler spins in a blocking dequeue call before it sleeps
+ *.
+ *
+ */
+#define UMS_DEFAULT_SPIN_THRESHOLD                                      50000
+
+/** @brief Flag of worker_params::flags declaring that the worker thread never uses FPU and vector registers
+ *.
+ *  FPU state is not switched for such worker threads, they have to be compiled and written accordingly (e.g. @c -mgeneral-regs-only)
+ */
+#define UMS_WORKER_NO_FPU                                               0x1
+
+/** @brief Signal sent to the pthread running a worker thread whose time quantum has expired, or whose worker thread has returned from a blocking call to the user space
+ *.
+ *  The UMS library handles it on the stack of the worker thread by issuing @c UMS_THREAD_PREEMPT, thus the stack of the worker thread has to fit a signal frame.
+ *  @c SIGURG is ignored by default, so that a pthread without the handler is not affected. A handler installed by the application before the UMS library is called for the signals not sent by UMS kernel module.
+ */
+#define UMS_PREEMPT_SIGNAL                                              SIGURG
+
 /** @brief States of processes, completion lists and threads (schedulers, worker threads)
  *.
  *  
@@ -122,6 +167,7 @@ typedef struct list_params {
     unsigned int size;              /**< Size of the worker thread array */
     unsigned int worker_count;      /**< Tracks the quantity of the available workers and used as state indicator for scheduler to perform a new dequeue call */
     state_t state;                  /**< Tracks the state of the completion list which is set by the kernel module after a dequeue call */
+    long timeout;                   /**< Time in milliseconds a blocking dequeue call waits for available worker threads, @ref UMS_WAIT_INFINITE to wait until there are any or the completion list is finished */
     ums_wid_t workers[];            /**< Array of worker threads. Stores ID of worker threads in case they are available to be scheduled (when worker thread is finished, scheduler replaces ID with -1 value) */
 } list_params_t;
 
@@ -135,6 +181,7 @@ typedef struct worker_params {
     unsigned long stack_size;       /**< Stack size of the worker thread set by a user */
     unsigned long stack_addr;       /**< Address of the stack allocated by the UMS library */
     ums_clid_t clid;                /**< ID of the completion list where worker thread is assigned to */
+    unsigned int flags;             /**< Flags of the worker thread, e.g. @ref UMS_WORKER_NO_FPU */
 } worker_params_t;
 
 /** @brief Parameters that are passed in order to create a scheduler
@@ -146,4 +193,190 @@ typedef struct scheduler_params {
     ums_clid_t clid;                /**< ID of the completion list that is assigned to the scheduler */
     ums_sid_t sid;                  /**< ID of the scheduler which is set by the kernel module */
     int core_id;                    /**< ID of the CPU core that is assigned to the scheduler (It is handled automatically by the library, no user input required) */
-} scheduler_params_t;
\ No newline at end of file
+    unsigned long spin_threshold;   /**< Maximum time in nanoseconds the scheduler spins in a blocking dequeue call before it sleeps, 0 to sleep right away */
+    unsigned long stack_addr;       /**< Address of the stack of the scheduler allocated by the UMS library, 0 to run the scheduler on the stack of the pthread */
+    unsigned int steal_batch;       /**< Maximum number of idle worker threads the scheduler takes at once from another completion list of the process when its' own completion list has none, 0 to disable work stealing */
+} scheduler_params_t;
+
+/** @brief Parameters that are passed by a worker thread in order to pause or complete its' execution and switch directly to the next worker thread
+ *.
+ *
+ */
+typedef struct switch_params {
+    ums_wid_t wid;                  /**< ID of the worker thread to switch to */
+    worker_status_t status;         /**< Status of the worker thread that issues the switch (@c PAUSE or @c FINISH) */
+} switch_params_t;
+
+/** @brief Parameters that are passed in order to set the time quantum of the completion list
+ *.
+ *
+ */
+typedef struct quantum_params {
+    ums_clid_t clid;                /**< ID of the completion list */
+    unsigned long quantum;          /**< Time in nanoseconds a worker thread of the completion list runs before it is preempted and returned to its' scheduler, 0 to disable preemption */
+} quantum_params_t;
+
+/** @brief Version of the layout of @ref stats_params, its' entries and @ref stats_page, it is changed whenever the layout changes
+ *.
+ *
+ */
+#define UMS_STATS_VERSION                   1
+
+/** @brief Types of the entries of @ref stats_params
+ *.
+ *
+ */
+typedef enum stats_type {
+    SCHEDULER_STATS,                /**< Entry is @ref scheduler_stats */
+    COMPLETION_LIST_STATS,          /**< Entry is @ref completion_list_stats */
+    WORKER_STATS                    /**< Entry is @ref worker_stats */
+} stats_type_t;
+
+/** @brief Counters of the scheduler
+ *.
+ *  Times are in nanoseconds
+ */
+typedef struct scheduler_stats {
+    ums_sid_t sid;                          /**< Scheduler ID */
+    ums_clid_t clid;                        /**< ID of the completion list that is assigned to the scheduler */
+    ums_wid_t wid;                          /**< ID of the worker thread currently run by the scheduler, -1 if none */
+    state_t state;                          /**< State of the scheduler */
+    unsigned long long switch_count;        /**< Number of context switches to worker threads */
+    unsigned long long switch_time;         /**< Total latency of the context switches */
+    unsigned long long min_switch_time;     /**< Minimum latency of the context switch, 0 if none was recorded */
+    unsigned long long max_switch_time;     /**< Maximum latency of the context switch */
+    unsigned long long steal_attempts;      /**< Number of work stealing attempts */
+    unsigned long long stolen_workers;      /**< Number of worker threads taken from other completion lists */
+} scheduler_stats_t;
+
+/** @brief Counters of the completion list
+ *.
+ *  Times are in nanoseconds, rates are moving averages of the events per second multiplied by 1000
+ */
+typedef struct completion_list_stats {
+    ums_clid_t clid;                        /**< Completion list ID */
+    state_t state;                          /**< State of the completion list */
+    unsigned int worker_count;              /**< Number of worker threads assigned to the completion list */
+    unsigned int idle_count;                /**< Number of worker threads waiting to be scheduled */
+    unsigned int finished_count;            /**< Number of worker threads that have completed their work */
+    unsigned int peak_idle_count;           /**< Maximum number of worker threads that were waiting to be scheduled at once */
+    unsigned int scheduler_count;           /**< Number of schedulers attached to the completion list */
+    unsigned int reserved;                  /**< Padding, set to 0 */
+    unsigned long long executes;            /**< Number of worker threads executed */
+    unsigned long long pauses;              /**< Number of worker threads paused */
+    unsigned long long finishes;            /**< Number of worker threads finished */
+    unsigned long long execute_rate;        /**< Executions per second, multiplied by 1000 */
+    unsigned long long pause_rate;          /**< Pauses per second, multiplied by 1000 */
+    unsigned long long finish_rate;         /**< Finishes per second, multiplied by 1000 */
+    unsigned long long wait_time;           /**< Total time worker threads waited to be executed */
+    unsigned long long max_wait_time;       /**< Maximum time a worker thread waited to be executed */
+} completion_list_stats_t;
+
+/** @brief Counters of the worker thread
+ *.
+ *  Times are in nanoseconds
+ */
+typedef struct worker_stats {
+    ums_wid_t wid;                          /**< Worker thread ID */
+    ums_sid_t sid;                          /**< ID of the scheduler that ran the worker thread last time, -1 if it was not run yet */
+    ums_clid_t clid;                        /**< ID of the completion list the worker thread is assigned to */
+    state_t state;                          /**< State of the worker thread */
+    unsigned long long switch_count;        /**< Number of times the worker thread was run */
+    unsigned long long quantum_expirations; /**< Number of times the worker thread was preempted */
+    unsigned long long exec_time;           /**< Time the worker thread ran, without the time it was off CPU */
+    unsigned long long user_time;           /**< User CPU time */
+    unsigned long long system_time;         /**< System CPU time */
+    unsigned long long off_cpu_time;        /**< Time the worker thread was off CPU while running */
+    unsigned long long wait_time;           /**< Total time the worker thread waited to be executed */
+    unsigned long long max_wait_time;       /**< Maximum time the worker thread waited to be executed */
+} worker_stats_t;
+
+/** @brief Entry of @ref stats_params
+ *.
+ *
+ */
+typedef struct stats_entry {
+    stats_type_t type;                          /**< Type of the entry */
+    union {
+        scheduler_stats_t scheduler;            /**< Set if stats_entry::type is @c SCHEDULER_STATS */
+        completion_list_stats_t comp_list;      /**< Set if stats_entry::type is @c COMPLETION_LIST_STATS */
+        worker_stats_t worker;                  /**< Set if stats_entry::type is @c WORKER_STATS */
+    };
+} stats_entry_t;
+
+/** @brief Parameters that are passed in order to retrieve the counters of the schedulers, completion lists and worker threads of the process
+ *.
+ *  Entries are stored in the order of schedulers, completion lists and worker threads, each ordered by ID.
+ *  If there are more of them than stats_params::size, the remaining ones are omitted and the counts tell how many entries are needed.
+ */
+typedef struct stats_params {
+    unsigned int version;                   /**< @ref UMS_STATS_VERSION the caller is built with, set by the caller */
+    unsigned int size;                      /**< Size of the entry array, set by the caller */
+    unsigned int entry_count;               /**< Number of entries stored, set by the kernel module */
+    unsigned int scheduler_count;           /**< Number of schedulers of the process, set by the kernel module */
+    unsigned int completion_list_count;     /**< Number of completion lists of the process, set by the kernel module */
+    unsigned int worker_count;              /**< Number of worker threads of the process, set by the kernel module */
+    stats_entry_t entries[];                /**< Array of entries */
+} stats_params_t;
+
+/** @brief Offset in pages of the mapping of the @ref stats_page on the UMS device
+ *.
+ *  Lower offsets select the @ref ready_ring of the completion list with the same ID, completion list IDs never reach it
+ */
+#define UMS_STATS_PAGE_PGOFF                (1UL << 32)
+
+/** @brief Maximum number of schedulers of the process whose counters are published in the @ref stats_page, schedulers with higher IDs are not published
+ *.
+ *
+ */
+#define UMS_STATS_PAGE_SCHEDULERS           255
+
+/** @brief Counters of the scheduler published in the @ref stats_page
+ *.
+ *  The entry is written by the pthread running the scheduler and protected by scheduler_live_stats::sequence:
+ *  it is odd while the entry is updated, thus a reader retries if it was odd or changed while the entry was read.
+ *  The entry takes a cache line, so that schedulers do not share them. Times are in nanoseconds.
+ */
+typedef struct scheduler_live_stats {
+    unsigned int sequence;                  /**< Sequence count of the updates of the entry */
+    ums_sid_t sid;                          /**< Scheduler ID */
+    ums_wid_t wid;                          /**< ID of the worker thread currently run by the scheduler, -1 if none */
+    state_t state;                          /**< State of the scheduler: IDLE while it runs its' entry point, RUNNING while it runs a worker thread, FINISHED after it exited scheduling mode */
+    unsigned long long switch_count;        /**< Number of context switches to worker threads */
+    unsigned long long switch_time;         /**< Total latency of the context switches */
+    unsigned long long last_switch_time;    /**< Monotonic time when the scheduler switched to a worker thread last time */
+    unsigned long long reserved[3];         /**< Padding to the cache line */
+} scheduler_live_stats_t;
+
+/** @brief Counters of the process shared read-only by the UMS kernel module with the user space
+ *.
+ *  The page is mapped by calling @c mmap() on the UMS device with the offset set to @ref UMS_STATS_PAGE_PGOFF multiplied by the page size.
+ *  The counters are updated in place by the context switches, thus they can be read without system calls, e.g. by the entry point of the scheduler.
+ */
+typedef struct stats_page {
+    unsigned int version;                   /**< @ref UMS_STATS_VERSION of the layout */
+    unsigned int scheduler_count;           /**< Number of published entries of stats_page::schedulers */
+    unsigned int reserved[14];              /**< Padding to the cache line */
+    scheduler_live_stats_t schedulers[UMS_STATS_PAGE_SCHEDULERS];   /**< Counters of the schedulers indexed by their IDs */
+} stats_page_t;
+
+/** @brief Number of entries in the @ref ready_ring (power of two)
+ *.
+ *
+ */
+#define UMS_READY_RING_SLOTS                1024
+
+/** @brief Ring of worker threads of the completion list that became available, shared by the UMS kernel module with the schedulers
+ *.
+ *  The ring is mapped by calling @c mmap() on the UMS device with the offset set to completion list ID multiplied by the page size.
+ *  The UMS kernel module publishes worker threads that became idle and advances @ref tail, schedulers consume them and advance @ref head with compare-and-swap.
+ *  Entries are hints: a consumed worker thread may have been claimed by a dequeue call meanwhile, thus executing it can fail.
+ *  When the ring is full, new entries are dropped and can be retrieved by a dequeue call only.
+ */
+typedef struct ready_ring {
+    unsigned int head;                          /**< Index of the next entry to be consumed, advanced by schedulers */
+    unsigned int tail;                          /**< Index of the next entry to be published, advanced by the UMS kernel module */
+    unsigned int worker_count;                  /**< Number of worker threads assigned to the completion list */
+    unsigned int finished_count;                /**< Number of worker threads that has completed their work */
+    ums_wid_t wids[UMS_READY_RING_SLOTS];       /**< IDs of worker threads that became available */
+} ready_ring_t;
\ No newline at end of file
@@ -26,49 +26,127 @@
  * @date 
  */
 #include "ums_api.h"
+#include "ums_trace.h"
 
 /*
  * Global variables
  */
 static struct proc_dir_entry *proc_ums;
 process_list_t process_list = {
-    .list = LIST_HEAD_INIT(process_list.list),
+    .lock = __SPIN_LOCK_UNLOCKED(process_list.lock),
+    .released = LIST_HEAD_INIT(process_list.released),
 };
+static host_list_t host_list = {
+    .lock = __SPIN_LOCK_UNLOCKED(host_list.lock),
+};
+static struct kmem_cache *worker_cache;
+static struct kmem_cache *scheduler_cache;
+static struct kmem_cache *completion_list_cache;
+static bool debug_fpu;
+module_param(debug_fpu, bool, 0644);
+MODULE_PARM_DESC(debug_fpu, "Check that worker threads created with UMS_WORKER_NO_FPU do not modify FPU state");
 
 /*
  * Static functions
  */
 static int scheduler_proc_open(struct inode *inode, struct file *file);
-static int worker_proc_open(struct inode *inode, struct file *file);
 static int scheduler_proc_show(struct seq_file *m, void *p);
 static int worker_proc_show(struct seq_file *m, void *p);
+static worker_t *find_process_worker(process_t *process, loff_t *pos);
+static worker_t *find_scheduler_worker(scheduler_t *scheduler, loff_t *pos);
+static void *scheduler_workers_start(struct seq_file *m, loff_t *pos);
+static void *scheduler_workers_next(struct seq_file *m, void *v, loff_t *pos);
+static void scheduler_workers_stop(struct seq_file *m, void *v);
+static void *process_workers_start(struct seq_file *m, loff_t *pos);
+static void *process_workers_next(struct seq_file *m, void *v, loff_t *pos);
+static void process_workers_stop(struct seq_file *m, void *v);
+static int process_workers_show(struct seq_file *m, void *v);
+static int completion_list_proc_open(struct inode *inode, struct file *file);
+static int completion_list_proc_show(struct seq_file *m, void *p);
+static void switch_fpu_regs(struct fpu *save, struct fpu *restore);
+static void save_worker_context(worker_t *worker);
+static void load_worker_context(worker_t *worker);
+static void save_context_regs(compact_context_t *context);
+static void load_context_regs(compact_context_t *context);
+static void save_context_fpu(compact_context_t *context);
+static void load_context_fpu(compact_context_t *context);
+static void snapshot_worker_fpu(scheduler_t *scheduler, worker_t *worker);
+static void check_worker_fpu(scheduler_t *scheduler, worker_t *worker);
+static void account_worker_time(worker_t *worker);
+static void init_latency_histogram(latency_histogram_t *histogram);
+static void record_latency(latency_histogram_t *histogram, u64 latency);
+static u64 get_latency_percentile(latency_histogram_t *histogram, unsigned int percent);
+static void show_latency_histogram(struct seq_file *m, const char *name, latency_histogram_t *histogram);
+static void update_event_rate(event_rate_t *rate, u64 elapsed, unsigned int intervals);
+static void update_completion_list_rates(completion_list_node_t *comp_list, u64 now);
+static void update_peak_idle_count(completion_list_node_t *comp_list);
+static void get_scheduler_stats(scheduler_t *scheduler, scheduler_stats_t *stats);
+static void get_completion_list_stats(completion_list_node_t *comp_list, completion_list_stats_t *stats);
+static void get_worker_stats(worker_t *worker, worker_stats_t *stats);
+static void publish_scheduler_stats(scheduler_t *scheduler);
+static process_t *get_current_process(file_context_t *context);
+static void unregister_process(process_t *process);
+static void free_process(struct kref *refcount);
+static int get_current_scheduler(file_context_t *context, scheduler_t **scheduler);
+static int switch_to_worker(file_context_t *context, ums_wid_t worker_id, worker_status_t status, bool directed);
+static int claim_worker(scheduler_t *scheduler, ums_wid_t worker_id, worker_t **worker);
+static void run_worker(scheduler_t *scheduler, worker_t *worker, worker_t *prev);
+static void release_worker(scheduler_t *scheduler, worker_t *worker, worker_status_t status);
+static void publish_ready_worker(completion_list_node_t *comp_list, ums_wid_t wid);
+static bool completion_list_has_items(completion_list_node_t *comp_list);
+static bool spin_on_completion_list(scheduler_t *scheduler, completion_list_node_t *comp_list);
+static long sleep_on_completion_list(completion_list_node_t *comp_list, long timeout);
+static void adapt_spin_threshold(scheduler_t *scheduler, bool grow);
+static unsigned int steal_workers(scheduler_t *scheduler);
+static host_t *get_current_host(file_context_t *context);
+static bool stop_host(host_t *host);
+static void free_host(host_t *host);
+static int host_task_exit(struct notifier_block *nb, unsigned long action, void *data);
+static void host_sched_in(struct preempt_notifier *notifier, int cpu);
+static void host_sched_out(struct preempt_notifier *notifier, struct task_struct *next);
+static void hand_off_scheduler(struct irq_work *work);
+static enum hrtimer_restart park_expired(struct hrtimer *timer);
+static bool park_host(file_context_t *context, worker_status_t status);
+static int wait_for_handoff(completion_list_node_t *comp_list, scheduler_t **scheduler);
+static void take_over_scheduler(file_context_t *context, host_t *host, scheduler_t *scheduler);
+static void return_to_scheduler(scheduler_t *scheduler, worker_status_t status);
+static enum hrtimer_restart quantum_expired(struct hrtimer *timer);
 
 /** @brief Called by a process to request a scheduling management
  *.
- *  Checks if the process is already managed or not, if not:
- *   - Creates a @ref process data structure by calling @ref create_process_node()
+ *  Checks if the process is already managed or the @p context is bound to a process already, if not:
+ *   - Creates a @ref process data structure by calling @ref create_process_node(), which fails if another call has registered the process meanwhile, and binds it to the @p context of the opened file, which takes a reference of the process
+ *   - Marks the @p context as the owner of the process, so that the process is finished when the file is released by @ref unbind_process()
  *   - Creates the proc entries by calling @ref create_process_proc_entry()
  *   
+ *  @param context pointer to @ref file_context of the opened UMS device
  *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
  */
-int enter_ums(void)
+int enter_ums(file_context_t *context)
 {
-    printk(KERN_INFO UMS_MODULE_NAME_LOG "-- Invocation of enter_ums()\n");
-    
     process_t *process;
+    int ret;
 
     process = check_if_process_exists(current->pid);
-    if(process != NULL)
+    if(process != NULL || READ_ONCE(context->process) != NULL)
     {
         return -UMS_ERROR_PROCESS_ALREADY_EXISTS;
     }
 
     process = create_process_node(current->pid);
+    if(process == NULL)
+    {
+        return -UMS_ERROR_PROCESS_ALREADY_EXISTS;
+    }
+    kref_get(&process->refcount);
+    context->owner = true;
+    WRITE_ONCE(context->process, process);
+    trace_ums_enter(process->pid);
     
-    int ret = create_process_proc_entry(process);
+    ret = create_process_proc_entry(process);
     if(ret != 0)
     {
-        printk(KERN_ALERT UMS_MODULE_NAME_LOG "--- Error: enter_ums() => %d\n", ret);
+        printk_ratelimited(KERN_ALERT UMS_MODULE_NAME_LOG "--- Error: enter_ums() => %d\n", ret);
         return ret;
     }
 
@@ -77,53 +155,156 @@ int enter_ums(void)
 
 /** @brief Called by a process to request a completion of the scheduling management
  *.
- *  Checks if the process is already managed or not, if not:
- *   - Sets the @ref state of the process to @c FINISHED, but does not delete related data structures of the process (which are deleted when UMS kernel module exits)
+ *  Checks if the process is managed and the call is issued by its' main thread, if so:
+ *   - Finishes the process by calling @ref unregister_process(), i.e. the process cannot be found anymore and its' proc entries are removed
+ *   - The data structures of the process are deleted by @ref free_process() once the opened files bound to it are released
  *   
+ *  @param context pointer to @ref file_context of the opened UMS device
  *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
  */
-int exit_ums(void)
+int exit_ums(file_context_t *context)
 {
-    printk(KERN_INFO UMS_MODULE_NAME_LOG "-- Invocation of exit_ums()\n");
-
     process_t *process;
 
-    process = check_if_process_exists(current->pid);
-    if(process == NULL)
+    process = get_current_process(context);
+    if(process == NULL || process->pid != current->pid)
     {
         return -UMS_ERROR_CMD_IS_NOT_ISSUED_BY_MAIN_THREAD;
     }
 
-    process->state = FINISHED;
-    //delete_process(process);
+    trace_ums_exit(process->pid);
+    unregister_process(process);
     
     return UMS_SUCCESS;
 }
 
+/** @brief Called when the opened UMS device is released to drop the reference of the process bound to the @p context
+ *.
+ *  If the process was registered through the file by @ref enter_ums(), it is finished by @ref unregister_process() as well,
+ *  thus the data structures of a process that exits without calling @ref exit_ums() are deleted once all its' files are closed.
+ *  If the @ref host of the file is still in use by another pthread (see @ref delete_host()), the schedulers of the process can still be reached through it,
+ *  then the reference is handed over to the host and dropped by @ref host_task_exit() when that pthread exits.
+ *
+ *  @param context pointer to @ref file_context of the released UMS device
+ *  @param host_in_use @c true if the @ref host of the file was not deleted
+ */
+void unbind_process(file_context_t *context, bool host_in_use)
+{
+    process_t *process = context->process;
+
+    if(process == NULL)
+    {
+        return;
+    }
+
+    if(context->owner)
+    {
+        unregister_process(process);
+    }
+    if(host_in_use)
+    {
+        context->process = NULL;
+        return;
+    }
+    context->process = NULL;
+    put_process(process);
+}
+
+/** @brief Finishes the @p process
+ *.
+ *  Under process_list::lock, unless the process is already finished:
+ *   - Sets the @ref state of the process to @c FINISHED, thus the files bound to it do not find it anymore
+ *   - Moves the process from process_list::table to process_list::released, so that lookups do not encounter finished processes
+ *  Then removes the proc entries of the process by calling @ref delete_process_proc_entry(), which waits for the readers of the entries,
+ *  and drops the reference held by process_list::table.
+ *
+ *  @param process pointer to @ref process
+ */
+static void unregister_process(process_t *process)
+{
+    bool registered;
+
+    spin_lock(&process_list.lock);
+    registered = process->state != FINISHED;
+    if(registered)
+    {
+        WRITE_ONCE(process->state, FINISHED);
+        hash_del_rcu(&process->node);
+        list_add_tail(&process->list, &process_list.released);
+        process_list.process_count--;
+    }
+    spin_unlock(&process_list.lock);
+
+    if(!registered)
+    {
+        return;
+    }
+    delete_process_proc_entry(process);
+    put_process(process);
+}
+
+/** @brief Drops a reference of the @p process, the process is deleted by @ref free_process() when the last reference is dropped
+ *.
+ *
+ *  @param process pointer to @ref process
+ */
+void put_process(process_t *process)
+{
+    kref_put(&process->refcount, free_process);
+}
+
+/** @brief Called when the last reference of the process is dropped
+ *.
+ *  No opened file is bound to the process and its' proc entries are removed, thus nothing can reach its' data structures,
+ *  the process is removed from process_list::released and deleted by @ref delete_process().
+ *
+ *  @param refcount process::refcount
+ */
+static void free_process(struct kref *refcount)
+{
+    process_t *process = container_of(refcount, process_t, refcount);
+
+    spin_lock(&process_list.lock);
+    list_del(&process->list);
+    spin_unlock(&process_list.lock);
+
+    delete_process(process);
+}
+
 /** @brief Creates a @ref process data structure to handle the specified process
  *.
  *  To create a @ref process data structure, UMS kernel module:
  *   - Allocates and initializes @ref process:
  *      - process::pid is set to @p pid
  *      - process::state is set to RUNNING
+ *      - process::refcount is initialized, the reference is held by process_list::table
+ *      - process::lock is initialized
+ *      - process::workers is initialized to index worker threads by their IDs
  *      - Allocates and initializes @ref completion_list member of the @ref process to track completion lists created by the process
  *      - Allocates and initializes @ref worker_list  member of the @ref process to track worker threads created by the process
  *      - Allocates and initializes @ref scheduler_list  member of the @ref process to track schedulers created by the process
+ *      - process::stats_page is allocated, so that it can be mapped via @ref mmap_stats_page() (if the allocation fails, the counters are not published)
+ *   - Publishes the fully initialized @ref process in the hashtable of the global @ref process_list under process_list::lock,
+ *     unless a process with the same @p pid was published meanwhile, so that concurrent calls do not register the process twice; then the new one is deleted
  *.
  *
  *  @param pid pid of the process
- *  @return returns a pointer to @ref process data structure of the specified process
+ *  @return returns a pointer to @ref process data structure of the specified process, or @c NULL if the process is registered already
  */
 process_t *create_process_node(pid_t pid)
 {
     process_t *process;
+    process_t *temp;
+    bool exists = false;
 
     process = kmalloc(sizeof(process_t), GFP_KERNEL);
-    list_add_tail(&process->list, &process_list.list);
-
-    process_list.process_count++;
     process->pid = pid;
     process->state = RUNNING;
+    kref_init(&process->refcount);
+    INIT_LIST_HEAD(&process->list);
+    process->proc_entry = NULL;
+    spin_lock_init(&process->lock);
+    xa_init_flags(&process->workers, XA_FLAGS_ALLOC);
 
     completion_list_t *comp_lists;
     comp_lists = kmalloc(sizeof(completion_list_t), GFP_KERNEL);
@@ -138,13 +319,38 @@ process_t *create_process_node(pid_t pid)
     work_list->worker_count = 0;
 
     scheduler_list_t *sched_list;
-    sched_list = kmalloc(sizeof(sched_list), GFP_KERNEL);
+    sched_list = kmalloc(sizeof(scheduler_list_t), GFP_KERNEL);
     process->scheduler_list = sched_list;
     INIT_LIST_HEAD(&sched_list->list);
     sched_list->scheduler_count = 0;
 
-    
+    process->stats_page = vmalloc_user(PAGE_ALIGN(sizeof(stats_page_t)));
+    if(process->stats_page != NULL)
+    {
+        process->stats_page->version = UMS_STATS_VERSION;
+    }
+
+    spin_lock(&process_list.lock);
+    hash_for_each_possible(process_list.table, temp, node, pid)
+    {
+        if(temp->pid == pid)
+        {
+            exists = true;
+            break;
+        }
+    }
+    if(!exists)
+    {
+        hash_add_rcu(process_list.table, &process->node, process->pid);
+        process_list.process_count++;
+    }
+    spin_unlock(&process_list.lock);
 
+    if(exists)
+    {
+        delete_process(process);
+        return NULL;
+    }
     return process;
 }
 
@@ -153,38 +359,66 @@ process_t *create_process_node(pid_t pid)
  *  To create a @ref completion_list_node, UMS kernel module:
  *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
  *   - Allocates and initializes @ref completion_list_node:
- *      - Adds the completion list to the list of completion lists created by the process
- *      - completion_list_node::clid is set to process::completion_lists::list_count value (which is incremented after)
+ *      - completion_list_node::lock is initialized
  *      - completion_list_node::worker_count is set to 0
  *      - completion_list_node::finished_count is set to 0
  *      - completion_list_node::state is set to IDLE
+ *      - completion_list_node::wait_queue is initialized
+ *      - Statistics of the completion list are cleared, the rates are sampled from now on
+ *      - completion_list_node::ready_ring is allocated, so that it can be mapped by the schedulers via @ref mmap_ready_ring()
+ *      - completion_list_node::workers is initialized to index the worker threads of the completion list by their IDs
  *      - Allocates and initializes @ref idle_list member of the @ref process to track idle worker threads created by the process
  *      - Allocates and initializes @ref busy_list  member of the @ref process to track finished and running worker threads created by the process
+ *   - Under process::lock:
+ *      - completion_list_node::clid is set to process::completion_lists::list_count value (which is incremented after)
+ *      - Adds the completion list to the list of completion lists created by the process
+ *   - Creates proc entries of the completion list by calling @ref create_completion_list_proc_entry(), a failure is logged only
  *  
+ *  @param context pointer to @ref file_context of the opened UMS device
  *  @return returns completion list ID
  */
-ums_clid_t create_completion_list()
+ums_clid_t create_completion_list(file_context_t *context)
 {
-    printk(KERN_INFO UMS_MODULE_NAME_LOG "-- Invocation of create_completion_list()\n");
-
     process_t *process;
     completion_list_node_t *comp_list;
     ums_clid_t list_id;
 
-    process = check_if_process_exists(current->pid);
-    if(process == NULL)
+    process = get_current_process(context);
+    if(process == NULL || process->pid != current->pid)
     {
         return -UMS_ERROR_PROCESS_NOT_FOUND;
     }
     
-    comp_list = kmalloc(sizeof(completion_list_node_t), GFP_KERNEL);
-    list_add_tail(&(comp_list->list), &process->completion_lists->list);
-
-    comp_list->clid = process->completion_lists->list_count;
-    process->completion_lists->list_count++;
+    comp_list = kmem_cache_alloc(completion_list_cache, GFP_KERNEL);
+    if(comp_list == NULL)
+    {
+        return -UMS_ERROR;
+    }
+    comp_list->ready_ring = vmalloc_user(PAGE_ALIGN(sizeof(ready_ring_t)));
+    if(comp_list->ready_ring == NULL)
+    {
+        kmem_cache_free(completion_list_cache, comp_list);
+        return -UMS_ERROR;
+    }
+    spin_lock_init(&comp_list->lock);
     comp_list->worker_count = 0;
     comp_list->finished_count = 0;
     comp_list->state = IDLE;
+    init_waitqueue_head(&comp_list->wait_queue);
+    spin_lock_init(&comp_list->standby_lock);
+    INIT_LIST_HEAD(&comp_list->handoff_list);
+    init_waitqueue_head(&comp_list->standby_wait);
+    atomic_set(&comp_list->standby_count, 0);
+    comp_list->quantum = 0;
+    init_latency_histogram(&comp_list->wait_time);
+    comp_list->scheduler_count = 0;
+    comp_list->peak_idle_count = 0;
+    memset(&comp_list->executes, 0, sizeof(event_rate_t));
+    memset(&comp_list->pauses, 0, sizeof(event_rate_t));
+    memset(&comp_list->finishes, 0, sizeof(event_rate_t));
+    comp_list->rate_time = ktime_get_ns();
+    comp_list->proc_entry = NULL;
+    xa_init(&comp_list->workers);
     
     worker_list_t *idle_list;
     idle_list = kmalloc(sizeof(worker_list_t), GFP_KERNEL);
@@ -198,7 +432,16 @@ ums_clid_t create_completion_list()
     INIT_LIST_HEAD(&comp_list->busy_list->list);
     busy_list->worker_count = 0;
 
+    spin_lock(&process->lock);
+    comp_list->clid = process->completion_lists->list_count;
+    process->completion_lists->list_count++;
+    list_add_tail(&(comp_list->list), &process->completion_lists->list);
     list_id = comp_list->clid;
+    spin_unlock(&process->lock);
+
+    create_completion_list_proc_entry(process, comp_list);
+    trace_ums_create_list(process->pid, list_id);
+
     return list_id;
 }
 
@@ -207,40 +450,42 @@ ums_clid_t create_completion_list()
  *  To create a @ref worker, UMS kernel module:
  *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
  *   - Checks if completion list exists based on the passed parameters @p params, if not returns @c UMS_ERROR_COMPLETION_LIST_NOT_FOUND
- *   - Checks if completion list is used currently, thus cannot be modified and returns @c UMS_ERROR_COMPLETION_LIST_IS_USED_AND_CANNOT_BE_MODIFIED
  *   - Allocates and initializes @ref worker:
- *      - Adds the worker to the list of workers created by the process
- *      - worker::wid is set to process::worker_list::worker_count value (which is incremented after)
+ *      - worker::wid is allocated from process::workers, the slot is reserved until the worker is fully initialized
  *      - worker::pid is set to -1
  *      - worker::tid is set to @c current->tgid
  *      - worker::clid is set to worker_params::clid
+ *      - worker::flags is set to worker_params::flags
  *      - worker::state is set to IDLE
  *      - worker::entry_point is set to worker_params::entry_point
  *      - worker::stack_addr is set to worker_params::stack_addr
  *      - worker::switch_count is set to 0;
  *      - worker::total_exec_time is set to 0;
- *      - worker::regs is a @c pt_regs data structure and set to a snapshot of current CPU registers of the process
- *          - regs::ip is set to worker_params::entry_point
- *          - regs::di is set to worker_params::function_args
- *          - regs::sp is set to worker_params::stack_addr
- *          - regs::bp is set to worker_params::stack_addr
- *      - worker::fpu_regs is a @c fpu data structure and set to a snapshot of current FPU registers of the process
- *      - Adds worker to the idle list of the completion list
+ *      - worker::context is a @ref compact_context set to a snapshot of current registers of the process by @ref save_worker_context()
+ *          - compact_context::ip is set to worker_params::entry_point
+ *          - compact_context::di is set to worker_params::function_args
+ *          - compact_context::sp is set to worker_params::stack_addr
+ *          - compact_context::bp is set to worker_params::stack_addr
+ *   - Under process::lock and completion_list_node::lock:
+ *      - Adds the worker to the list of workers created by the process
+ *      - Publishes the worker in process::workers (its' ID was reserved before), so that it can be found by its' ID
+ *      - Adds worker to the idle list of the completion list and publishes it in completion_list_node::ready_ring.
+ *        The completion list can be used by schedulers already: worker threads are submitted dynamically, the completion list is not finished anymore
+ *   - Wakes up a scheduler sleeping in @ref dequeue_completion_list_items_wait()
  * 
+ *  @param context pointer to @ref file_context of the opened UMS device
  *  @param params pointer to @ref worker_params
  *  @return returns worker ID
  */
-ums_wid_t create_worker_thread(worker_params_t *params)
+ums_wid_t create_worker_thread(file_context_t *context, worker_params_t *params)
 {
-    printk(KERN_INFO UMS_MODULE_NAME_LOG "-- Invocation of create_worker_thread()\n");
-
     process_t *process;
     worker_t *worker;
     completion_list_node_t *comp_list;
     ums_wid_t worker_id;
     worker_params_t kern_params;
 
-    process = check_if_process_exists(current->pid);
+    process = get_current_process(context);
     if(process == NULL)
     {
         return -UMS_ERROR_PROCESS_NOT_FOUND;
@@ -249,7 +494,7 @@ ums_wid_t create_worker_thread(worker_params_t *params)
     int ret = copy_from_user(&kern_params, params, sizeof(worker_params_t));
     if(ret != 0)
     {
-        printk(KERN_ALERT UMS_MODULE_NAME_LOG "--- Error: create_worker_thread() => copy_from_user failed to copy %d bytes\n", ret);
+        printk_ratelimited(KERN_ALERT UMS_MODULE_NAME_LOG "--- Error: create_worker_thread() => copy_from_user failed to copy %d bytes\n", ret);
         return ret;
     }
 
@@ -259,40 +504,73 @@ ums_wid_t create_worker_thread(worker_params_t *params)
         return -UMS_ERROR_COMPLETION_LIST_NOT_FOUND;
     }
 
-    if(comp_list->state == RUNNING)
+    worker = kmem_cache_alloc(worker_cache, GFP_KERNEL);
+    if(worker == NULL)
     {
-        return -UMS_ERROR_COMPLETION_LIST_IS_USED_AND_CANNOT_BE_MODIFIED;
+        return -UMS_ERROR;
     }
 
-    worker = kmalloc(sizeof(worker_t), GFP_KERNEL);
-    list_add_tail(&(worker->global_list), &process->worker_list->list);
+    ret = xa_alloc(&process->workers, &worker->wid, NULL, xa_limit_31b, GFP_KERNEL);
+    if(ret != 0)
+    {
+        printk_ratelimited(KERN_ALERT UMS_MODULE_NAME_LOG "--- Error: create_worker_thread() => xa_alloc failed with %d\n", ret);
+        kmem_cache_free(worker_cache, worker);
+        return ret;
+    }
 
-    worker->wid = process->worker_list->worker_count;
     worker->pid = -1;
     worker->tid = current->tgid;
     worker->sid = -1;
     worker->clid = comp_list->clid;
+    worker->flags = kern_params.flags;
     worker->state = IDLE;
     worker->entry_point = kern_params.entry_point;
     worker->stack_addr = kern_params.stack_addr;
     worker->switch_count = 0;
+    worker->quantum_expirations = 0;
     worker->total_exec_time = 0;
+    worker->off_cpu_time = 0;
+    worker->user_time = 0;
+    worker->system_time = 0;
+    worker->regs_switch_time = 0;
+    worker->fpu_switch_time = 0;
+    worker->total_wait_time = 0;
+    worker->last_wait_time = 0;
+    worker->max_wait_time = 0;
+
+    save_worker_context(worker);
+
+    worker->context.ip = kern_params.entry_point;
+    worker->context.di = kern_params.function_args;
+    worker->context.sp = kern_params.stack_addr;
+    worker->context.bp = kern_params.stack_addr;
+
+    spin_lock(&process->lock);
+    spin_lock(&comp_list->lock);
+    list_add_tail(&(worker->global_list), &process->worker_list->list);
+    process->worker_list->worker_count++;
 
-    memcpy(&worker->regs, task_pt_regs(current), sizeof(struct pt_regs));
-    memset(&worker->fpu_regs, 0, sizeof(struct fpu));
-    copy_fxregs_to_kernel(&worker->fpu_regs);
+    worker_id = worker->wid;
+    xa_store(&process->workers, worker_id, worker, GFP_ATOMIC);
 
-    worker->regs.ip = kern_params.entry_point;
-    worker->regs.di = kern_params.function_args;
-    worker->regs.sp = kern_params.stack_addr;
-    worker->regs.bp = kern_params.stack_addr;
+    xa_store(&comp_list->workers, worker_id, worker, GFP_ATOMIC);
 
+    worker->idle_since = ktime_get_ns();
     list_add_tail(&(worker->local_list), &comp_list->idle_list->list);
     comp_list->idle_list->worker_count++;
     comp_list->worker_count++;
-    process->worker_list->worker_count++;
+    update_peak_idle_count(comp_list);
+    WRITE_ONCE(comp_list->ready_ring->worker_count, comp_list->worker_count);
+    publish_ready_worker(comp_list, worker_id);
+    spin_unlock(&comp_list->lock);
+    spin_unlock(&process->lock);
+
+    if(wq_has_sleeper(&comp_list->wait_queue))
+    {
+        wake_up_interruptible(&comp_list->wait_queue);
+    }
+    trace_ums_create_worker(process->pid, worker_id, worker->clid);
 
-    worker_id = worker->wid;
     return worker_id;
 }
 
@@ -302,41 +580,47 @@ ums_wid_t create_worker_thread(worker_params_t *params)
  *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
  *   - Checks if completion list exists based on the passed parameters @p params, if not returns @c UMS_ERROR_COMPLETION_LIST_NOT_FOUND
  *   - Allocates and initializes @ref scheduler:
- *      - Adds the scheduler to the list of schedulers created by the process
- *      - scheduler::sid is set to process::scheduler_list::scheduler_count; value (which is incremented after)
  *      - scheduler::pid is set to @c current->pid
  *      - scheduler::tid is set to @c current->tgid
  *      - scheduler::wid is set to -1
+ *      - scheduler::process is set to the pointer of the process
  *      - scheduler::state is set to IDLE
  *      - scheduler::entry_point is set to scheduler_params::entry_point
  *      - scheduler::avg_switch_time is set to 0;
  *      - scheduler::time_needed_for_the_last_switch is set to 0;
  *      - scheduler::total_time_needed_for_the_switch is set to 0;
+ *      - Switch latency statistics and scheduler::switch_latency are cleared
+ *      - scheduler::spin_limit and scheduler::spin_threshold are set to scheduler_params::spin_threshold
+ *      - scheduler::steal_batch is set to scheduler_params::steal_batch, work stealing statistics are set to 0
  *      - scheduler::comp_list is set to the pointer of the completion list retrieved using @ref check_if_completion_list_exists by passing scheduler_params::clid
- *      - scheduler::regs is a @c pt_regs data structure and set to a snapshot of current CPU registers of the pthread
- *          - scheduler::return_addr is set to regs::ip
- *          - scheduler::stack_ptr is set to regs::sp
- *          - scheduler::base_ptr is set to regs::bp
- *          - regs::ip is set to scheduler_params::entry_point
- *      - scheduler::fpu_regs is a @c fpu data structure and set to a snapshot of current FPU registers of the pthread
- *      - Sets the state of the completion list assigned to that scheduler to RUNNING, since the scheduling starts after the completion of ioctl call
+ *      - scheduler::sid is set to process::scheduler_list::scheduler_count value (which is incremented after) under process::lock and copied to scheduler_params::sid
+ *      - scheduler::context is a @ref compact_context set to the registers and FPU control words of the pthread, which are saved to host::home as well
+ *          - compact_context::ip is set to scheduler_params::entry_point
+ *          - compact_context::sp and compact_context::bp are set to scheduler_params::stack_addr, if the scheduler has its' own stack
+ *   - Makes the pthread the @ref host of the scheduler by calling @ref get_current_host(), the pthread returns to host::home when it stops running the scheduler
+ *   - Registers host::notifier, so that the scheduler is handed off to a standby pthread when the worker thread run by it blocks in the kernel
  *      - Creates @ref scheduler_proc_entry for the scheduler by calling @ref create_scheduler_proc_entry()
- *      - Performs a context switch by copying previosly saved and modified scheduler::regs data structure to @c task_pt_regs(current)
+ *   - If any of the steps above fails, the scheduler is freed, only its' ID is not reused. Otherwise the scheduler is published:
+ *      - The scheduler is added to the list of schedulers created by the process under process::lock
+ *      - scheduler::live_stats is set to the entry of process::stats_page indexed by the scheduler ID and the counters are published by @ref publish_scheduler_stats()
+ *      - Sets the state of the completion list assigned to that scheduler to RUNNING and attaches the scheduler to it (completion_list_node::scheduler_count) under completion_list_node::lock, since the scheduling starts after the completion of ioctl call
+ *      - Binds the scheduler to the @p context of the opened file, so that the following calls of the pthread reach the scheduler without any lookups
+ *      - Performs a context switch to scheduler::context by calling @ref load_context_regs()
  *      
+ *  @param context pointer to @ref file_context of the opened UMS device
  *  @param params pointer to @ref scheduler_params
  *  @return returns scheduler ID
  */
-ums_sid_t enter_scheduling_mode(scheduler_params_t *params)
+ums_sid_t enter_scheduling_mode(file_context_t *context, scheduler_params_t *params)
 {
-    printk(KERN_INFO UMS_MODULE_NAME_LOG "-- Invocation of enter_scheduling_mode()\n");
-    
     process_t *process;
     scheduler_t *scheduler;
     completion_list_node_t *comp_list;
     ums_sid_t scheduler_id;
     scheduler_params_t kern_params;
+    host_t *host;
 
-    process = check_if_process_exists(current->tgid);
+    process = get_current_process(context);
     if(process == NULL)
     {
         return -UMS_ERROR_PROCESS_NOT_FOUND;
@@ -345,7 +629,7 @@ ums_sid_t enter_scheduling_mode(scheduler_params_t *params)
     int ret = copy_from_user(&kern_params, params, sizeof(scheduler_params_t));
     if(ret != 0)
     {
-        printk(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: enter_scheduling_mode(): copy_from_user failed to copy %d bytes\n", ret);
+        printk_ratelimited(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: enter_scheduling_mode(): copy_from_user failed to copy %d bytes\n", ret);
         return ret;
     }
 
@@ -355,13 +639,27 @@ ums_sid_t enter_scheduling_mode(scheduler_params_t *params)
         return -UMS_ERROR_COMPLETION_LIST_NOT_FOUND;
     }
 
-    scheduler = kmalloc(sizeof(scheduler_t), GFP_KERNEL);
-    list_add_tail(&(scheduler->list), &process->scheduler_list->list);
+    host = get_current_host(context);
+    if(host == NULL)
+    {
+        return -UMS_ERROR;
+    }
+    if(host->scheduler != NULL)
+    {
+        return -UMS_ERROR_STATE_RUNNING;
+    }
+
+    scheduler = kmem_cache_zalloc(scheduler_cache, GFP_KERNEL);
+    if(scheduler == NULL)
+    {
+        return -UMS_ERROR;
+    }
 
-    scheduler->sid = process->scheduler_list->scheduler_count;
     scheduler->pid = current->pid;
     scheduler->tid = current->tgid;
     scheduler->wid = -1;
+    scheduler->worker = NULL;
+    scheduler->process = process;
     scheduler->state = IDLE;
     scheduler->entry_point = kern_params.entry_point;
     scheduler->comp_list = comp_list;
@@ -369,35 +667,81 @@ ums_sid_t enter_scheduling_mode(scheduler_params_t *params)
     scheduler->avg_switch_time = 0;
     scheduler->time_needed_for_the_last_switch = 0;
     scheduler->total_time_needed_for_the_switch = 0;
-    scheduler_id = scheduler->sid;
+    init_latency_histogram(&scheduler->switch_latency);
+    scheduler->spin_limit = kern_params.spin_threshold;
+    scheduler->spin_threshold = kern_params.spin_threshold;
+    init_irq_work(&scheduler->irq_work, hand_off_scheduler);
+    INIT_LIST_HEAD(&scheduler->handoff_list);
+    scheduler->host = host;
+    hrtimer_init(&scheduler->quantum_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL_PINNED);
+    scheduler->quantum_timer.function = quantum_expired;
+    scheduler->preempt_pending = 0;
+    scheduler->preempt_switch = 0;
+    scheduler->steal_batch = kern_params.steal_batch;
+    scheduler->steal_attempts = 0;
+    scheduler->steal_successes = 0;
+    scheduler->stolen_workers = 0;
+    scheduler->fpu_saved = false;
+    scheduler->fpu_check = NULL;
+    scheduler->fpu_check_armed = false;
+
+    spin_lock(&process->lock);
+    scheduler->sid = process->scheduler_list->scheduler_count;
+    process->scheduler_list->scheduler_count++;
+    spin_unlock(&process->lock);
 
+    scheduler_id = scheduler->sid;
     kern_params.sid = scheduler_id;
     ret = copy_to_user(params, &kern_params, sizeof(scheduler_params_t));
     if(ret != 0)
     {
-        printk(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: enter_scheduling_mode(): copy_to_user failed to copy %d bytes\n", ret);
+        printk_ratelimited(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: enter_scheduling_mode(): copy_to_user failed to copy %d bytes\n", ret);
+        kmem_cache_free(scheduler_cache, scheduler);
         return ret;
     }
 
-    memcpy(&scheduler->regs, task_pt_regs(current), sizeof(struct pt_regs));
-    memset(&scheduler->fpu_regs, 0, sizeof(struct fpu));
-    copy_fxregs_to_kernel(&scheduler->fpu_regs);
+    save_context_regs(&host->home);
+    save_context_fpu(&host->home);
 
-    scheduler->return_addr = scheduler->regs.ip;
-    scheduler->stack_ptr = scheduler->regs.sp;
-    scheduler->base_ptr = scheduler->regs.bp;
-    scheduler->regs.ip = kern_params.entry_point;
-    process->scheduler_list->scheduler_count++;
-    comp_list->state = RUNNING;
+    scheduler->context = host->home;
+    scheduler->context.ip = kern_params.entry_point;
+    if(kern_params.stack_addr != 0)
+    {
+        scheduler->context.sp = kern_params.stack_addr;
+        scheduler->context.bp = kern_params.stack_addr;
+    }
 
     ret = create_scheduler_proc_entry(process, scheduler);
     if(ret != 0)
     {
-        printk(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: enter_scheduling_mode(): %d\n", ret);
+        printk_ratelimited(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: enter_scheduling_mode(): %d\n", ret);
+        delete_scheduler_proc_entry(scheduler);
+        kmem_cache_free(scheduler_cache, scheduler);
         return ret;
     }
 
-    memcpy(task_pt_regs(current), &scheduler->regs, sizeof(struct pt_regs));
+    spin_lock(&process->lock);
+    list_add_tail(&(scheduler->list), &process->scheduler_list->list);
+    if(process->stats_page != NULL && scheduler->sid < UMS_STATS_PAGE_SCHEDULERS)
+    {
+        scheduler->live_stats = &process->stats_page->schedulers[scheduler->sid];
+        WRITE_ONCE(process->stats_page->scheduler_count, scheduler->sid + 1);
+    }
+    spin_unlock(&process->lock);
+    publish_scheduler_stats(scheduler);
+
+    spin_lock(&comp_list->lock);
+    comp_list->state = RUNNING;
+    comp_list->scheduler_count++;
+    spin_unlock(&comp_list->lock);
+
+    WRITE_ONCE(context->scheduler, scheduler);
+    trace_ums_enter_scheduling_mode(scheduler->pid, scheduler_id, comp_list->clid);
+
+    host->scheduler = scheduler;
+    preempt_notifier_register(&host->notifier);
+
+    load_context_regs(&scheduler->context);
         
     return scheduler_id;
 }
@@ -405,53 +749,48 @@ ums_sid_t enter_scheduling_mode(scheduler_params_t *params)
 /** @brief Converts @ref scheduler back to the pthread
  *
  *  To create a @ref scheduler, UMS kernel module:
- *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
- *   - Checks if scheduler associated by the pthread already exists, if not returns @c UMS_ERROR_SCHEDULER_NOT_FOUND
+ *   - Retrieves the scheduler associated with the pthread by calling @ref get_current_scheduler(), which returns @c UMS_ERROR_PROCESS_NOT_FOUND or @c UMS_ERROR_SCHEDULER_NOT_FOUND on failure
+ *   - Checks that the scheduler is hosted by the pthread through the @p context, otherwise returns @c UMS_ERROR_CMD_IS_NOT_ISSUED_BY_SCHEDULER
  *   - Modifies @ref scheduler:
- *      - scheduler::wid is set to -1
  *      - scheduler::state is set to FINISHED
- *      - scheduler::regs is modified:
- *          - regs::ip is set to scheduler::return_addr 
- *          - regs::sp is set to scheduler::stack_ptr
- *          - regs::bp is set to scheduler::base_ptr
- *          - regs::ip is set to scheduler_params::entry_point
- *      - Performs a context switch by copying previosly saved and modified scheduler::regs data structure to @c task_pt_regs(current)
- *      - Changes current FPU registers to previously saved scheduller::fpu_regs via @c copy_kernel_to_fxregs()
+ *   - Detaches the scheduler from its' completion list by decrementing completion_list_node::scheduler_count
+ *   - Unregisters host::notifier of the pthread
+ *   - Performs a context switch to host::home by calling @ref load_context_regs() and @ref load_context_fpu(), i.e. the pthread returns from the call that made it the host of the scheduler:
+ *     @c UMS_ENTER_SCHEDULING_MODE or @c UMS_ENTER_STANDBY if the scheduler was handed off to it
  *      
+ *  @param context pointer to @ref file_context of the opened UMS device
  *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
  */
-int exit_scheduling_mode(void)
+int exit_scheduling_mode(file_context_t *context)
 {
-    printk(KERN_INFO UMS_MODULE_NAME_LOG "-- Invocation of exit_scheduling_mode()\n");
-    
-    process_t *process;
     scheduler_t *scheduler;
+    host_t *host;
+    int ret;
     
-    process = check_if_process_exists(current->tgid);
-    if(process == NULL)
-    {
-        return -UMS_ERROR_PROCESS_NOT_FOUND;
-    }
-
-    scheduler = check_if_scheduler_exists_run_by(process, current->pid);
-    if(scheduler == NULL)
+    ret = get_current_scheduler(context, &scheduler);
+    if(ret != UMS_SUCCESS)
     {
-        return -UMS_ERROR_SCHEDULER_NOT_FOUND;
+        return ret;
     }
 
-    if(scheduler->wid != -1)
+    host = context->host;
+    if(scheduler->wid != -1 || host == NULL || host->task != current || host->scheduler != scheduler)
     {
         return -UMS_ERROR_CMD_IS_NOT_ISSUED_BY_SCHEDULER;
     }
     scheduler->state = FINISHED;
+    publish_scheduler_stats(scheduler);
+    spin_lock(&scheduler->comp_list->lock);
+    scheduler->comp_list->scheduler_count--;
+    spin_unlock(&scheduler->comp_list->lock);
+    trace_ums_exit_scheduling_mode(scheduler->pid, scheduler->sid, scheduler->comp_list->clid);
 
+    preempt_notifier_unregister(&host->notifier);
+    host->scheduler = NULL;
+    WRITE_ONCE(scheduler->host, NULL);
 
-    scheduler->regs.ip = scheduler->return_addr;
-    scheduler->regs.sp = scheduler->stack_ptr;
-    scheduler->regs.bp = scheduler->base_ptr;
-
-    memcpy(task_pt_regs(current), &scheduler->regs, sizeof(struct pt_regs));
-    copy_kernel_to_fxregs(&scheduler->fpu_regs.state.fxsave);
+    load_context_regs(&host->home);
+    load_context_fpu(&host->home);
 
     return UMS_SUCCESS;
 }
@@ -459,84 +798,40 @@ int exit_scheduling_mode(void)
 /** @brief Executes a worker thread with a @p worker_id
  *.
  *  To execute the worker thread: 
- *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
- *   - Checks if scheduler associated by the pthread already exists, if not returns @c UMS_ERROR_SCHEDULER_NOT_FOUND
- *   - Checks if the worker thread exists, currently running, completed its' work
- *   - Updates the worker and scheduler data structures
- *   - Records the statistics related to the scheduler and worker, such as number of switches and the time the switch happened
- *   - Saves the register values of the scheduler
- *   - Performs a context switch
+ *   - Retrieves the scheduler associated with the pthread by calling @ref get_current_scheduler(), which returns @c UMS_ERROR_PROCESS_NOT_FOUND or @c UMS_ERROR_SCHEDULER_NOT_FOUND on failure
+ *   - Checks that the scheduler does not run a worker thread already, otherwise returns @c UMS_ERROR_CMD_IS_NOT_ISSUED_BY_SCHEDULER
+ *   - Claims the worker thread by calling @ref claim_worker()
+ *   - Saves the register values of the scheduler and performs a context switch by calling @ref run_worker()
  *   
  *
+ *  @param context pointer to @ref file_context of the opened UMS device
  *  @param worker_id Worker thread ID
  *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
  */
-int execute_thread(ums_wid_t worker_id)
+int execute_thread(file_context_t *context, ums_wid_t worker_id)
 {
-    printk(KERN_INFO UMS_MODULE_NAME_LOG "-- Invocation of execute_thread()\n");
-
-    process_t *process;
     worker_t *worker;
     scheduler_t *scheduler;
-    completion_list_node_t *comp_list;
-
-    process = check_if_process_exists(current->tgid);
-    if(process == NULL)
-    {
-        return -UMS_ERROR_PROCESS_NOT_FOUND;
-    }
+    int ret;
 
-    scheduler = check_if_scheduler_exists_run_by(process, current->pid);
-    if(scheduler == NULL)
+    ret = get_current_scheduler(context, &scheduler);
+    if(ret != UMS_SUCCESS)
     {
-        return -UMS_ERROR_SCHEDULER_NOT_FOUND;
+        return ret;
     }
 
-    comp_list = scheduler->comp_list;
-    worker = check_if_worker_exists(comp_list->idle_list, worker_id);
-    if(worker == NULL)
+    if(scheduler->worker != NULL)
     {
-        return -UMS_ERROR_WORKER_NOT_FOUND;
+        return -UMS_ERROR_CMD_IS_NOT_ISSUED_BY_SCHEDULER;
     }
 
-    if(worker->state == RUNNING)
+    ret = claim_worker(scheduler, worker_id, &worker);
+    if(ret != UMS_SUCCESS)
     {
-        return -UMS_ERROR_WORKER_ALREADY_RUNNING;
-
-    }
-    if(worker->state == FINISHED)
-    {
-        return -UMS_ERROR_WORKER_ALREADY_FINISHED;
-
+        return ret;
     }
 
-
-    scheduler->switch_count++;
-    worker->switch_count++;
-
-    ktime_get_real_ts64(&scheduler->time_of_the_last_switch);
-    ktime_get_real_ts64(&worker->time_of_the_last_switch);
-
-    worker->state = RUNNING;
-    worker->sid = scheduler->sid;
-    worker->pid = current->pid;
-    scheduler->wid = worker->wid;
-    scheduler->state = RUNNING;
-
-    list_move_tail(&(worker->local_list), &comp_list->busy_list->list);
-    comp_list->idle_list->worker_count--;
-    comp_list->busy_list->worker_count++;
-
-    memcpy(&scheduler->regs, task_pt_regs(current), sizeof(struct pt_regs));
-    copy_fxregs_to_kernel(&scheduler->fpu_regs);
-
-    memcpy(task_pt_regs(current), &worker->regs, sizeof(struct pt_regs));
-    copy_kernel_to_fxregs(&worker->fpu_regs.state.fxsave);
-
-    scheduler->time_needed_for_the_last_switch = get_exec_time(&scheduler->time_of_the_last_switch);
-    scheduler->total_time_needed_for_the_switch += scheduler->time_needed_for_the_last_switch;
-
-    scheduler->avg_switch_time = scheduler->total_time_needed_for_the_switch / scheduler->switch_count;
+    run_worker(scheduler, worker, NULL);
 
     return UMS_SUCCESS;
 }
@@ -544,159 +839,1723 @@ int execute_thread(ums_wid_t worker_id)
 /** @brief Pauses or completes the execution of the worker thread
  *.
  *  To pause or complete the execution of the worker thread: 
- *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
- *   - Checks if scheduler associated by the pthread already exists, if not returns @c UMS_ERROR_SCHEDULER_NOT_FOUND
- *   - Checks if the worker thread exists, currently running, completed its' work
- *   - Updates the worker, scheduler and completion list data structures:
- *      - if @p status is set to PAUSE:
- *          - worker::state is set to IDLE, so that it can be scheduled later
- *          - worker is added back to the completion list 
- *      - if @p status is set to FINISH:
- *          - worker::state is set to FINISHED
- *          - completion list increments the value of finished workers
- *   - Records the statistics related to the scheduler and worker, such as number of switches and the time the switch happened
- *   - Saves the register values of the worker thread
- *   - Performs a context switch
+ *   - If the worker thread has blocked in the kernel and its' scheduler was handed off, parks the pthread by calling @ref park_host() and returns @c UMS_HOST_PARKED
+ *   - Retrieves the scheduler associated with the pthread by calling @ref get_current_scheduler(), which returns @c UMS_ERROR_PROCESS_NOT_FOUND or @c UMS_ERROR_SCHEDULER_NOT_FOUND on failure
+ *   - Takes the worker thread currently run by the scheduler from scheduler::worker, if there is none returns @c UMS_ERROR_CMD_IS_NOT_ISSUED_BY_WORKER
+ *   - Switches back to the scheduler by calling @ref return_to_scheduler()
  *   
  *
+ *  @param context pointer to @ref file_context of the opened UMS device
  *  @param status value of @ref worker_status, which is the status of the worker thread
  *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
  */
-int thread_yield(worker_status_t status)
+int thread_yield(file_context_t *context, worker_status_t status)
 {
-    printk(KERN_INFO UMS_MODULE_NAME_LOG "-- Invocation of thread_yield()\n");
-
-    process_t *process;
-    worker_t *worker;
     scheduler_t *scheduler;
-    completion_list_node_t *comp_list;
+    int ret;
 
     if(status != FINISH && status != PAUSE) 
     {
         return -UMS_ERROR_WRONG_INPUT;
     }
 
-    process = check_if_process_exists(current->tgid);
-    if(process == NULL)
+    if(park_host(context, status))
     {
-        return -UMS_ERROR_PROCESS_NOT_FOUND;
+        return UMS_HOST_PARKED;
     }
 
-    scheduler = check_if_scheduler_exists_run_by(process, current->pid);
-    if(scheduler == NULL)
+    ret = get_current_scheduler(context, &scheduler);
+    if(ret != UMS_SUCCESS)
     {
-        return -UMS_ERROR_SCHEDULER_NOT_FOUND;
+        return ret;
     }
 
-    comp_list = scheduler->comp_list;
-    worker = check_if_worker_exists(comp_list->busy_list, scheduler->wid);
-    if(worker == NULL)
+    if(scheduler->worker == NULL)
     {
-        return -UMS_ERROR_WORKER_NOT_FOUND;
+        return -UMS_ERROR_CMD_IS_NOT_ISSUED_BY_WORKER;
     }
 
-    worker->total_exec_time += get_exec_time(&worker->time_of_the_last_switch);
+    return_to_scheduler(scheduler, status);
 
-    worker->state = (status == PAUSE) ? IDLE : FINISHED;
-    scheduler->wid = -1;
-    scheduler->state = IDLE;
-    comp_list->finished_count = (status == PAUSE) ? comp_list->finished_count : comp_list->finished_count + 1;
+    return UMS_SUCCESS;
+}
 
-    if(status == PAUSE)
+/** @brief Switches from the running worker thread directly to the worker thread with a @p worker_id
+ *.
+ *  Combines @ref thread_yield() with @c PAUSE and @ref execute_thread() in a single call, thus the scheduler is not entered in between:
+ *   - Retrieves the scheduler associated with the pthread by calling @ref get_current_scheduler(), which returns @c UMS_ERROR_PROCESS_NOT_FOUND or @c UMS_ERROR_SCHEDULER_NOT_FOUND on failure
+ *   - Takes the worker thread currently run by the scheduler from scheduler::worker, if there is none returns @c UMS_ERROR_CMD_IS_NOT_ISSUED_BY_WORKER
+ *   - Claims the target worker thread by calling @ref claim_worker(), on failure returns its' error and the running worker thread continues its' execution
+ *   - Saves the register values of the running worker thread and switches to the target one by calling @ref run_worker()
+ *   - Returns the paused worker thread to the completion list by calling @ref release_worker()
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param worker_id ID of the worker thread to switch to
+ *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
+ */
+int switch_to_thread(file_context_t *context, ums_wid_t worker_id)
+{
+    return switch_to_worker(context, worker_id, PAUSE, false);
+}
+
+/** @brief Pauses or completes the execution of the worker thread and names its' successor
+ *.
+ *  Directed version of @ref thread_yield():
+ *   - Copies @ref switch_params from the user space
+ *   - Switches to the worker thread switch_params::wid as @ref switch_to_thread() does, but the running worker thread is paused or completed depending on switch_params::status
+ *   - If the successor cannot be claimed (e.g. it is run by another scheduler or has finished), falls back to @ref thread_yield(), so that the scheduler picks the next worker thread
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param params pointer to @ref switch_params
+ *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
+ */
+int thread_yield_to(file_context_t *context, switch_params_t *params)
+{
+    switch_params_t kern_params;
+    int ret;
+
+    ret = copy_from_user(&kern_params, params, sizeof(switch_params_t));
+    if(ret != 0)
     {
-        list_move_tail(&(worker->local_list), &comp_list->idle_list->list);
-        comp_list->busy_list->worker_count--;
-        comp_list->idle_list->worker_count++;
+        printk_ratelimited(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: thread_yield_to(): copy_from_user failed to copy %d bytes\n", ret);
+        return ret;
     }
 
-    memcpy(&worker->regs, task_pt_regs(current), sizeof(struct pt_regs));
-    copy_fxregs_to_kernel(&worker->fpu_regs);
-
-    memcpy(task_pt_regs(current), &scheduler->regs, sizeof(struct pt_regs));
-    copy_kernel_to_fxregs(&scheduler->fpu_regs.state.fxsave);
+    if(kern_params.status != FINISH && kern_params.status != PAUSE) 
+    {
+        return -UMS_ERROR_WRONG_INPUT;
+    }
 
-    return UMS_SUCCESS;
+    return switch_to_worker(context, kern_params.wid, kern_params.status, true);
 }
 
-/** @brief Provides a list of available worker threads of the completion list that can be scheduled
+/** @brief Switches from the running worker thread to the worker thread with a @p worker_id
  *.
- *   To retrieve the list of available worker threads: 
- *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
- *   - Checks if scheduler associated by the pthread already exists, if not returns @c UMS_ERROR_SCHEDULER_NOT_FOUND
- *   - Checks if there are any available workers, if not modifes @p params state value to FINISHED to indicate the completion of the work
- *   - Retrieves the list of idle worker threads from the completion list and copies them back to the @p params
+ *  Implements @ref switch_to_thread() and @ref thread_yield_to().
+ *  If the worker thread has blocked in the kernel and its' scheduler was handed off, the pthread is parked by @ref park_host() instead and the worker thread with a @p worker_id is not run.
  *
- *
- *  @param params pointer to @ref list_params
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param worker_id ID of the worker thread to switch to
+ *  @param status value of @ref worker_status, which is the status of the running worker thread
+ *  @param directed @c true if the call falls back to @ref thread_yield() when the worker thread cannot be claimed
  *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
  */
-int dequeue_completion_list_items(list_params_t *params)
+static int switch_to_worker(file_context_t *context, ums_wid_t worker_id, worker_status_t status, bool directed)
 {
-    printk(KERN_INFO UMS_MODULE_NAME_LOG "-- Invocation of dequeue_completion_list_items()\n");
-
-    process_t *process;
-    worker_t *worker;
+    worker_t *prev;
+    worker_t *next;
     scheduler_t *scheduler;
-    completion_list_node_t *comp_list;
-    list_params_t *kern_params;
-    unsigned int size;
+    int ret;
 
-    process = check_if_process_exists(current->tgid);
-    if(process == NULL)
+    if(park_host(context, status))
     {
-        return -UMS_ERROR_PROCESS_NOT_FOUND;
+        return UMS_HOST_PARKED;
     }
-    
-    scheduler = check_if_scheduler_exists_run_by(process, current->pid);
-    if(scheduler == NULL)
+
+    ret = get_current_scheduler(context, &scheduler);
+    if(ret != UMS_SUCCESS)
     {
-        kfree(kern_params);
-        return -UMS_ERROR_SCHEDULER_NOT_FOUND;
+        return ret;
     }
 
-    comp_list = scheduler->comp_list;
+    prev = scheduler->worker;
+    if(prev == NULL)
+    {
+        return -UMS_ERROR_CMD_IS_NOT_ISSUED_BY_WORKER;
+    }
 
-    kern_params = kmalloc(sizeof(list_params_t) + comp_list->worker_count * sizeof(ums_wid_t), GFP_KERNEL);
-    int ret = copy_from_user(kern_params, params, sizeof(list_params_t) + comp_list->worker_count * sizeof(ums_wid_t));
-    if(ret != 0)
+    ret = claim_worker(scheduler, worker_id, &next);
+    if(ret != UMS_SUCCESS)
     {
-        printk(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: dequeue_completion_list_items(): copy_from_user failed to copy %d bytes\n", ret);
-        kfree(kern_params);
-        return ret;
+        return directed ? thread_yield(context, status) : ret;
     }
-    
-    kern_params->state = comp_list->finished_count == comp_list->worker_count ? FINISHED : IDLE;
 
+    account_worker_time(prev);
+
+    run_worker(scheduler, next, prev);
+    release_worker(scheduler, prev, status);
+
+    return UMS_SUCCESS;
+}
+
+/** @brief Claims an idle worker thread with a @p worker_id of the completion list of the @p scheduler
+ *.
+ *   - Finds the worker thread by its' ID in process::workers, if not returns @c UMS_ERROR_WORKER_NOT_FOUND
+ *   - Under completion_list_node::lock checks if the worker thread belongs to the completion list of the scheduler, currently running, completed its' work and claims it by moving it to the busy list
+ *   - Records the time the worker thread waited in the idle list since worker::idle_since in its' statistics and completion_list_node::wait_time
+ *   - Counts the execution in completion_list_node::executes
+ *
+ *  @param scheduler pointer to @ref scheduler
+ *  @param worker_id Worker thread ID
+ *  @param worker pointer where the claimed @ref worker is stored
+ *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
+ */
+static int claim_worker(scheduler_t *scheduler, ums_wid_t worker_id, worker_t **worker)
+{
+    completion_list_node_t *comp_list = scheduler->comp_list;
+    worker_t *temp;
+    u64 now, wait_time;
+
+    temp = check_if_worker_exists(scheduler->process, worker_id);
+    if(temp == NULL)
+    {
+        return -UMS_ERROR_WORKER_NOT_FOUND;
+    }
+
+    now = ktime_get_ns();
+    spin_lock(&comp_list->lock);
+    if(temp->clid != comp_list->clid)
+    {
+        spin_unlock(&comp_list->lock);
+        return -UMS_ERROR_WORKER_NOT_FOUND;
+    }
+    if(temp->state != IDLE)
+    {
+        spin_unlock(&comp_list->lock);
+        return temp->state == FINISHED ? -UMS_ERROR_WORKER_ALREADY_FINISHED : -UMS_ERROR_WORKER_ALREADY_RUNNING;
+    }
+
+    temp->state = RUNNING;
+    list_move_tail(&(temp->local_list), &comp_list->busy_list->list);
+    comp_list->idle_list->worker_count--;
+    comp_list->busy_list->worker_count++;
+    wait_time = now > temp->idle_since ? now - temp->idle_since : 0;
+    record_latency(&comp_list->wait_time, wait_time);
+    comp_list->executes.count++;
+    update_completion_list_rates(comp_list, now);
+    spin_unlock(&comp_list->lock);
+
+    temp->last_wait_time = wait_time;
+    temp->total_wait_time += wait_time;
+    if(wait_time > temp->max_wait_time)
+    {
+        temp->max_wait_time = wait_time;
+    }
+
+    *worker = temp;
+    return UMS_SUCCESS;
+}
+
+/** @brief Switches the pthread of the @p scheduler to the claimed @p worker
+ *.
+ *   - Updates the worker and scheduler data structures; they are owned by the scheduler from now on, therefore no lock is held
+ *   - Records the statistics related to the scheduler and worker, such as number of switches, the time the switch happened and CPU time of the pthread used by @ref account_worker_time()
+ *     and publishes the counters of the scheduler by calling @ref publish_scheduler_stats()
+ *   - Saves current registers and FPU control words to scheduler::context, or to the compact context of the worker thread @p prev that is switched from.
+ *     The control words are saved even if the worker thread is created with @ref UMS_WORKER_NO_FPU, so that they are ready when the scheduler is handed off
+ *   - Sets scheduler::fpu_saved unless the worker thread is created with @ref UMS_WORKER_NO_FPU, i.e. FPU registers do not hold the control words of the scheduler anymore
+ *   - Performs a context switch by calling @ref load_worker_context()
+ *   - Arms scheduler::quantum_timer if the completion list has a time quantum, so that the worker thread is preempted by @ref quantum_expired() when it expires.
+ *     A preemption signalled for the previous worker thread is detected as stale by @ref preempt_thread() through scheduler::preempt_switch
+ *
+ *  @param scheduler pointer to @ref scheduler
+ *  @param worker pointer to @ref worker claimed by @ref claim_worker()
+ *  @param prev pointer to @ref worker the pthread switches from, or @c NULL if it switches from the scheduler
+ */
+static void run_worker(scheduler_t *scheduler, worker_t *worker, worker_t *prev)
+{
+    u64 quantum;
+    u64 now;
+
+    scheduler->switch_count++;
+    worker->switch_count++;
+
+    now = ktime_get_ns();
+    scheduler->time_of_the_last_switch = now;
+    worker->time_of_the_last_switch = now;
+    worker->off_cpu_at_switch = worker->off_cpu_time;
+    worker->utime_at_switch = current->utime;
+    worker->stime_at_switch = current->stime;
+
+    worker->sid = scheduler->sid;
+    worker->pid = current->pid;
+    scheduler->wid = worker->wid;
+    scheduler->worker = worker;
+    scheduler->state = RUNNING;
+    publish_scheduler_stats(scheduler);
+    trace_ums_execute(scheduler->pid, scheduler->sid, worker->wid, scheduler->comp_list->clid, RUNNING);
+
+    if(prev == NULL)
+    {
+        save_context_regs(&scheduler->context);
+        save_context_fpu(&scheduler->context);
+    }
+    else
+    {
+        check_worker_fpu(scheduler, prev);
+        save_worker_context(prev);
+    }
+    if(!(worker->flags & UMS_WORKER_NO_FPU))
+    {
+        scheduler->fpu_saved = true;
+    }
+    load_worker_context(worker);
+    snapshot_worker_fpu(scheduler, worker);
+
+    quantum = READ_ONCE(scheduler->comp_list->quantum);
+    if(quantum != 0)
+    {
+        scheduler->quantum_cpu = raw_smp_processor_id();
+        hrtimer_start(&scheduler->quantum_timer, ns_to_ktime(quantum), HRTIMER_MODE_REL_PINNED);
+    }
+    else
+    {
+        hrtimer_try_to_cancel(&scheduler->quantum_timer);
+    }
+}
+
+/** @brief Returns the @p worker switched from by the @p scheduler to its' completion list
+ *.
+ *  The registers of the worker thread must be saved already. Under completion_list_node::lock:
+ *   - if @p status is set to PAUSE:
+ *      - worker::state is set to IDLE, so that it can be scheduled later
+ *      - worker::idle_since is set to the current monotonic time, so that @ref claim_worker() accounts the time the worker thread waits to be executed
+ *      - worker is added back to the completion list and published in completion_list_node::ready_ring
+ *      - the pause is counted in completion_list_node::pauses
+ *   - if @p status is set to FINISH:
+ *      - worker::state is set to FINISHED
+ *      - completion list increments the value of finished workers (also in completion_list_node::ready_ring) and completion_list_node::finishes
+ *  Then wakes up a scheduler sleeping in @ref dequeue_completion_list_items_wait() if the worker was paused, or all of them if the completion list is finished.
+ *  Standby pthreads of the completion list are woken up as well when it is finished, so that they exit @ref enter_standby().
+ *
+ *  @param scheduler pointer to @ref scheduler
+ *  @param worker pointer to @ref worker
+ *  @param status value of @ref worker_status, which is the status of the worker thread
+ */
+static void release_worker(scheduler_t *scheduler, worker_t *worker, worker_status_t status)
+{
+    completion_list_node_t *comp_list = scheduler->comp_list;
+    bool wake;
+    u64 now;
+
+    trace_ums_yield(scheduler->pid, scheduler->sid, worker->wid, comp_list->clid, status == PAUSE ? IDLE : FINISHED);
+
+    now = ktime_get_ns();
+    spin_lock(&comp_list->lock);
+    if(status == PAUSE)
+    {
+        worker->state = IDLE;
+        worker->idle_since = now;
+        list_move_tail(&(worker->local_list), &comp_list->idle_list->list);
+        comp_list->busy_list->worker_count--;
+        comp_list->idle_list->worker_count++;
+        update_peak_idle_count(comp_list);
+        comp_list->pauses.count++;
+        publish_ready_worker(comp_list, worker->wid);
+    }
+    else
+    {
+        worker->state = FINISHED;
+        comp_list->finished_count++;
+        comp_list->finishes.count++;
+        WRITE_ONCE(comp_list->ready_ring->finished_count, comp_list->finished_count);
+    }
+    update_completion_list_rates(comp_list, now);
+    wake = status == PAUSE || comp_list->finished_count == comp_list->worker_count;
+    spin_unlock(&comp_list->lock);
+
+    if(wake && wq_has_sleeper(&comp_list->wait_queue))
+    {
+        if(status == PAUSE)
+        {
+            wake_up_interruptible(&comp_list->wait_queue);
+        }
+        else
+        {
+            wake_up_interruptible_all(&comp_list->wait_queue);
+        }
+    }
+    if(wake && status == FINISH && wq_has_sleeper(&comp_list->standby_wait))
+    {
+        wake_up_interruptible_all(&comp_list->standby_wait);
+    }
+}
+
+/** @brief Provides a list of available worker threads of the completion list that can be scheduled
+ *.
+ *   To retrieve the list of available worker threads: 
+ *   - Retrieves the scheduler associated with the pthread by calling @ref get_current_scheduler(), which returns @c UMS_ERROR_PROCESS_NOT_FOUND or @c UMS_ERROR_SCHEDULER_NOT_FOUND on failure
+ *   - If the completion list has no idle worker threads and work stealing is enabled, takes idle worker threads of another completion list by calling @ref steal_workers()
+ *   - Checks if there are any available workers, if not modifes @p params state value to FINISHED to indicate the completion of the work
+ *   - Retrieves the list of idle worker threads from the completion list under completion_list_node::lock and copies them back to the @p params (copying from and to user space is done without holding the lock).
+ *     At most list_params::size worker threads are returned, since the completion list can grow by work stealing.
+ *     The kernel buffer is sized for list_params::size clamped to completion_list_node::worker_count, only the header is copied in and only the filled entries are copied out
+ *   - Drops the entries of completion_list_node::ready_ring, since all idle worker threads are returned
+ *
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param params pointer to @ref list_params
+ *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
+ */
+int dequeue_completion_list_items(file_context_t *context, list_params_t *params)
+{
+    scheduler_t *scheduler;
+    completion_list_node_t *comp_list;
+    list_params_t *kern_params;
+    unsigned int entries;
     unsigned int count = 0;
-    
+    int ret;
+
+    ret = get_current_scheduler(context, &scheduler);
+    if(ret != UMS_SUCCESS)
+    {
+        return ret;
+    }
+
+    ret = get_user(entries, &params->size);
+    if(ret != 0)
+    {
+        printk_ratelimited(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: dequeue_completion_list_items(): get_user failed with %d\n", ret);
+        return ret;
+    }
+
+    comp_list = scheduler->comp_list;
+    if(scheduler->steal_batch != 0 && READ_ONCE(comp_list->idle_list->worker_count) == 0)
+    {
+        steal_workers(scheduler);
+    }
+    entries = min_t(unsigned int, entries, READ_ONCE(comp_list->worker_count));
+
+    kern_params = kmalloc(struct_size(kern_params, workers, entries), GFP_KERNEL);
+    if(kern_params == NULL)
+    {
+        return -ENOMEM;
+    }
+    ret = copy_from_user(kern_params, params, sizeof(list_params_t));
+    if(ret != 0)
+    {
+        printk_ratelimited(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: dequeue_completion_list_items(): copy_from_user failed to copy %d bytes\n", ret);
+        kfree(kern_params);
+        return ret;
+    }
+
+    spin_lock(&comp_list->lock);
+    kern_params->state = comp_list->finished_count == comp_list->worker_count ? FINISHED : IDLE;
     if(!list_empty(&comp_list->idle_list->list))
     {
-        worker_t *temp = NULL;
-        worker_t *safe_temp = NULL;
-        list_for_each_entry_safe(temp, safe_temp, &comp_list->idle_list->list, local_list) 
+        worker_t *temp = NULL;
+        worker_t *safe_temp = NULL;
+        list_for_each_entry_safe(temp, safe_temp, &comp_list->idle_list->list, local_list) 
+        {
+            if (count >= entries) break;
+            kern_params->workers[count] = temp->wid;
+            count++;
+        }
+    }
+    smp_store_release(&comp_list->ready_ring->head, READ_ONCE(comp_list->ready_ring->tail));
+    spin_unlock(&comp_list->lock);
+
+    kern_params->worker_count = count;
+    trace_ums_dequeue(scheduler->pid, scheduler->sid, comp_list->clid, count, kern_params->state);
+
+    ret = copy_to_user(params, kern_params, struct_size(kern_params, workers, count));
+    if(ret != 0)
+    {
+        printk_ratelimited(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: dequeue_completion_list_items(): copy_to_user failed to copy %d bytes\n", ret);
+        kfree(kern_params);
+        return ret;
+    }
+
+    kfree(kern_params);
+    return UMS_SUCCESS;
+}
+
+/** @brief Provides a list of available worker threads of the completion list, waiting for them if there are none
+ *.
+ *   To retrieve the list of available worker threads: 
+ *   - Retrieves the scheduler associated with the pthread by calling @ref get_current_scheduler(), which returns @c UMS_ERROR_PROCESS_NOT_FOUND or @c UMS_ERROR_SCHEDULER_NOT_FOUND on failure
+ *   - Reads list_params::timeout from @p params
+ *   - If there are no idle worker threads and the completion list is not finished:
+ *      - Takes idle worker threads of another completion list by calling @ref steal_workers(), if work stealing is enabled
+ *      - Spins for at most scheduler::spin_threshold nanoseconds via @ref spin_on_completion_list(), since a worker thread is often paused soon by another scheduler
+ *      - Otherwise sleeps on completion_list_node::wait_queue via @ref sleep_on_completion_list() until @ref thread_yield() wakes it up or the timeout expires
+ *      - Adapts scheduler::spin_threshold by calling @ref adapt_spin_threshold(): it grows if worker threads became available within scheduler::spin_limit and shrinks otherwise
+ *   - Retrieves the list of available worker threads by calling @ref dequeue_completion_list_items(), the list is empty if the timeout has expired
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param params pointer to @ref list_params
+ *  @return returns @c UMS_SUCCESS when succesful, @c -ERESTARTSYS if interrupted by a signal or error constant if there are any errors  
+ */
+int dequeue_completion_list_items_wait(file_context_t *context, list_params_t *params)
+{
+    scheduler_t *scheduler;
+    completion_list_node_t *comp_list;
+    long timeout;
+    u64 start;
+    int ret;
+
+    ret = get_current_scheduler(context, &scheduler);
+    if(ret != UMS_SUCCESS)
+    {
+        return ret;
+    }
+
+    ret = get_user(timeout, &params->timeout);
+    if(ret != 0)
+    {
+        printk_ratelimited(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: dequeue_completion_list_items_wait(): get_user failed with %d\n", ret);
+        return ret;
+    }
+
+    comp_list = scheduler->comp_list;
+    if(completion_list_has_items(comp_list))
+    {
+        goto out;
+    }
+    if(scheduler->steal_batch != 0 && steal_workers(scheduler) != 0)
+    {
+        goto out;
+    }
+
+    start = ktime_get_ns();
+    if(spin_on_completion_list(scheduler, comp_list))
+    {
+        adapt_spin_threshold(scheduler, true);
+        goto out;
+    }
+
+    timeout = sleep_on_completion_list(comp_list, timeout < 0 ? MAX_SCHEDULE_TIMEOUT : msecs_to_jiffies(timeout));
+    if(timeout < 0)
+    {
+        return timeout;
+    }
+    adapt_spin_threshold(scheduler, completion_list_has_items(comp_list) && ktime_get_ns() - start <= scheduler->spin_limit);
+
+    out:
+    return dequeue_completion_list_items(context, params);
+}
+
+/** @brief Maps completion_list_node::ready_ring of the completion list selected by the offset of the mapping
+ *.
+ *  To map the ring:
+ *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
+ *   - The offset of the mapping in pages is the completion list ID, if there is no such completion list returns @c UMS_ERROR_COMPLETION_LIST_NOT_FOUND
+ *   - Maps the ring, the mapping must not be larger than the ring and must be shared
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param vma memory area of the mapping
+ *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
+ */
+int mmap_ready_ring(file_context_t *context, struct vm_area_struct *vma)
+{
+    process_t *process;
+    completion_list_node_t *comp_list;
+
+    process = get_current_process(context);
+    if(process == NULL)
+    {
+        return -UMS_ERROR_PROCESS_NOT_FOUND;
+    }
+
+    comp_list = check_if_completion_list_exists(process, vma->vm_pgoff);
+    if(comp_list == NULL)
+    {
+        return -UMS_ERROR_COMPLETION_LIST_NOT_FOUND;
+    }
+
+    if(!(vma->vm_flags & VM_SHARED))
+    {
+        return -EINVAL;
+    }
+
+    return remap_vmalloc_range(vma, comp_list->ready_ring, 0);
+}
+
+/** @brief Maps process::stats_page of the process read-only
+ *.
+ *  Called for the mapping of the UMS device at the offset of @c UMS_STATS_PAGE_PGOFF pages:
+ *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
+ *   - Checks that the page was allocated, otherwise returns @c UMS_ERROR
+ *   - Checks that the mapping is not writable, otherwise returns @c EPERM, and prevents it from becoming writable by @c mprotect()
+ *   - Maps the page, the mapping must not be larger than the page
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param vma memory area of the mapping
+ *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
+ */
+int mmap_stats_page(file_context_t *context, struct vm_area_struct *vma)
+{
+    process_t *process;
+
+    process = get_current_process(context);
+    if(process == NULL)
+    {
+        return -UMS_ERROR_PROCESS_NOT_FOUND;
+    }
+    if(process->stats_page == NULL)
+    {
+        return -UMS_ERROR;
+    }
+
+    if(vma->vm_flags & VM_WRITE)
+    {
+        return -EPERM;
+    }
+    vma->vm_flags &= ~VM_MAYWRITE;
+
+    return remap_vmalloc_range(vma, process->stats_page, 0);
+}
+
+/** @brief Retrieves the process of the pthread that issues the call through the @p context
+ *.
+ *  The process bound to the @p context is used directly, thus no lookup is performed.
+ *  Otherwise the process is looked up by @c current->tgid with @ref get_process() and bound to the @p context, which keeps the reference of the process until the file is released.
+ *  If several pthreads bind the shared file at once, the process bound first is kept and the other references are dropped.
+ *  The process bound to the file is not returned once it is finished or if the call is issued by another process (e.g. the file was inherited by @c fork()).
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @return returns pointer to @ref process or @c NULL if the process is not managed
+ */
+static process_t *get_current_process(file_context_t *context)
+{
+    process_t *process = READ_ONCE(context->process);
+    process_t *bound;
+
+    if(process == NULL)
+    {
+        process = get_process(current->tgid);
+        if(process == NULL)
+        {
+            return NULL;
+        }
+        bound = cmpxchg(&context->process, NULL, process);
+        if(bound != NULL)
+        {
+            put_process(process);
+            process = bound;
+        }
+    }
+
+    if(process->pid != current->tgid || READ_ONCE(process->state) == FINISHED)
+    {
+        return NULL;
+    }
+    return process;
+}
+
+/** @brief Sets the time quantum of the completion list
+ *.
+ *  To set the time quantum:
+ *   - Copies @ref quantum_params from the user space
+ *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
+ *   - Checks if the completion list exists, if not returns @c UMS_ERROR_COMPLETION_LIST_NOT_FOUND
+ *   - Checks that the time quantum is 0 or not shorter than @c UMS_MIN_QUANTUM, otherwise returns @c UMS_ERROR_WRONG_INPUT
+ *   - Sets completion_list_node::quantum, it applies to the following switches to worker threads
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param params pointer to @ref quantum_params
+ *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
+ */
+int set_completion_list_quantum(file_context_t *context, quantum_params_t *params)
+{
+    process_t *process;
+    completion_list_node_t *comp_list;
+    quantum_params_t kern_params;
+
+    int ret = copy_from_user(&kern_params, params, sizeof(quantum_params_t));
+    if(ret != 0)
+    {
+        printk_ratelimited(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: set_completion_list_quantum(): copy_from_user failed to copy %d bytes\n", ret);
+        return ret;
+    }
+
+    process = get_current_process(context);
+    if(process == NULL)
+    {
+        return -UMS_ERROR_PROCESS_NOT_FOUND;
+    }
+
+    comp_list = check_if_completion_list_exists(process, kern_params.clid);
+    if(comp_list == NULL)
+    {
+        return -UMS_ERROR_COMPLETION_LIST_NOT_FOUND;
+    }
+
+    if(kern_params.quantum != 0 && kern_params.quantum < UMS_MIN_QUANTUM)
+    {
+        return -UMS_ERROR_WRONG_INPUT;
+    }
+
+    WRITE_ONCE(comp_list->quantum, kern_params.quantum);
+    return UMS_SUCCESS;
+}
+
+/** @brief Retrieves the counters of the schedulers, completion lists and worker threads of the process in binary form
+ *.
+ *  To retrieve the counters:
+ *   - Copies the header of @ref stats_params from the user space, if stats_params::version is not @c UMS_STATS_VERSION returns @c UMS_ERROR_WRONG_INPUT
+ *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
+ *   - Reads the number of schedulers, completion lists and worker threads under process::lock and allocates at most stats_params::size entries for them
+ *   - Under process::lock fills the entries of the schedulers by calling @ref get_scheduler_stats() and the entries of the completion lists by calling @ref get_completion_list_stats()
+ *   - Fills the entries of the worker threads by calling @ref get_worker_stats(), they are found in process::workers without holding a lock
+ *   - Copies the header and the entries back to the @p params at once
+ *
+ *  The counters of the schedulers and worker threads are updated by the pthreads running them without locking, thus the entries are consistent per counter, not as a whole.
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param params pointer to @ref stats_params
+ *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
+ */
+int get_stats(file_context_t *context, stats_params_t *params)
+{
+    process_t *process;
+    stats_params_t kern_params;
+    stats_params_t *stats;
+    scheduler_t *scheduler;
+    completion_list_node_t *comp_list;
+    worker_t *worker;
+    unsigned long index;
+    unsigned int size, count = 0;
+
+    int ret = copy_from_user(&kern_params, params, sizeof(stats_params_t));
+    if(ret != 0)
+    {
+        printk_ratelimited(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: get_stats(): copy_from_user failed to copy %d bytes\n", ret);
+        return ret;
+    }
+
+    if(kern_params.version != UMS_STATS_VERSION)
+    {
+        return -UMS_ERROR_WRONG_INPUT;
+    }
+
+    process = get_current_process(context);
+    if(process == NULL)
+    {
+        return -UMS_ERROR_PROCESS_NOT_FOUND;
+    }
+
+    spin_lock(&process->lock);
+    kern_params.scheduler_count = process->scheduler_list->scheduler_count;
+    kern_params.completion_list_count = process->completion_lists->list_count;
+    kern_params.worker_count = process->worker_list->worker_count;
+    spin_unlock(&process->lock);
+
+    size = min(kern_params.size, kern_params.scheduler_count + kern_params.completion_list_count + kern_params.worker_count);
+    stats = kvzalloc(struct_size(stats, entries, size), GFP_KERNEL);
+    if(stats == NULL)
+    {
+        return -UMS_ERROR;
+    }
+
+    spin_lock(&process->lock);
+    list_for_each_entry(scheduler, &process->scheduler_list->list, list)
+    {
+        if(count >= size) break;
+        stats->entries[count].type = SCHEDULER_STATS;
+        get_scheduler_stats(scheduler, &stats->entries[count++].scheduler);
+    }
+    list_for_each_entry(comp_list, &process->completion_lists->list, list)
+    {
+        if(count >= size) break;
+        stats->entries[count].type = COMPLETION_LIST_STATS;
+        get_completion_list_stats(comp_list, &stats->entries[count++].comp_list);
+    }
+    spin_unlock(&process->lock);
+
+    xa_for_each(&process->workers, index, worker)
+    {
+        if(count >= size) break;
+        stats->entries[count].type = WORKER_STATS;
+        get_worker_stats(worker, &stats->entries[count++].worker);
+    }
+
+    stats->version = UMS_STATS_VERSION;
+    stats->size = kern_params.size;
+    stats->entry_count = count;
+    stats->scheduler_count = kern_params.scheduler_count;
+    stats->completion_list_count = kern_params.completion_list_count;
+    stats->worker_count = kern_params.worker_count;
+
+    ret = copy_to_user(params, stats, struct_size(stats, entries, count));
+    kvfree(stats);
+    if(ret != 0)
+    {
+        printk_ratelimited(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: get_stats(): copy_to_user failed to copy %d bytes\n", ret);
+        return ret;
+    }
+    return UMS_SUCCESS;
+}
+
+/** @brief Fills the counters of the @p scheduler
+ *.
+ *
+ *  @param scheduler pointer to @ref scheduler
+ *  @param stats pointer to @ref scheduler_stats
+ */
+static void get_scheduler_stats(scheduler_t *scheduler, scheduler_stats_t *stats)
+{
+    stats->sid = scheduler->sid;
+    stats->clid = scheduler->comp_list->clid;
+    stats->wid = READ_ONCE(scheduler->wid);
+    stats->state = READ_ONCE(scheduler->state);
+    stats->switch_count = scheduler->switch_count;
+    stats->switch_time = scheduler->switch_latency.total;
+    stats->min_switch_time = scheduler->switch_latency.count != 0 ? scheduler->switch_latency.min : 0;
+    stats->max_switch_time = scheduler->switch_latency.max;
+    stats->steal_attempts = scheduler->steal_attempts;
+    stats->stolen_workers = scheduler->stolen_workers;
+}
+
+/** @brief Fills the counters of the @p comp_list
+ *.
+ *  Takes completion_list_node::lock and brings the rates up to date by calling @ref update_completion_list_rates()
+ *
+ *  @param comp_list pointer to @ref completion_list_node
+ *  @param stats pointer to @ref completion_list_stats
+ */
+static void get_completion_list_stats(completion_list_node_t *comp_list, completion_list_stats_t *stats)
+{
+    spin_lock(&comp_list->lock);
+    update_completion_list_rates(comp_list, ktime_get_ns());
+    stats->clid = comp_list->clid;
+    stats->state = comp_list->state;
+    stats->worker_count = comp_list->worker_count;
+    stats->idle_count = comp_list->idle_list->worker_count;
+    stats->finished_count = comp_list->finished_count;
+    stats->peak_idle_count = comp_list->peak_idle_count;
+    stats->scheduler_count = comp_list->scheduler_count;
+    stats->executes = comp_list->executes.count;
+    stats->pauses = comp_list->pauses.count;
+    stats->finishes = comp_list->finishes.count;
+    stats->execute_rate = comp_list->executes.rate;
+    stats->pause_rate = comp_list->pauses.rate;
+    stats->finish_rate = comp_list->finishes.rate;
+    stats->wait_time = comp_list->wait_time.total;
+    stats->max_wait_time = comp_list->wait_time.max;
+    spin_unlock(&comp_list->lock);
+}
+
+/** @brief Fills the counters of the @p worker
+ *.
+ *
+ *  @param worker pointer to @ref worker
+ *  @param stats pointer to @ref worker_stats
+ */
+static void get_worker_stats(worker_t *worker, worker_stats_t *stats)
+{
+    stats->wid = worker->wid;
+    stats->sid = READ_ONCE(worker->sid);
+    stats->clid = READ_ONCE(worker->clid);
+    stats->state = READ_ONCE(worker->state);
+    stats->switch_count = worker->switch_count;
+    stats->quantum_expirations = worker->quantum_expirations;
+    stats->exec_time = worker->total_exec_time;
+    stats->user_time = worker->user_time;
+    stats->system_time = worker->system_time;
+    stats->off_cpu_time = worker->off_cpu_time;
+    stats->wait_time = worker->total_wait_time;
+    stats->max_wait_time = worker->max_wait_time;
+}
+
+/** @brief Publishes the counters of the @p scheduler to its' entry of process::stats_page
+ *.
+ *  Called by the pthread running the scheduler whenever it switches, thus the entry has a single writer and plain stores are used.
+ *  scheduler_live_stats::sequence is incremented before and after the update with write barriers in between, so that readers in the user space detect torn reads and retry.
+ *
+ *  @param scheduler pointer to @ref scheduler
+ */
+static void publish_scheduler_stats(scheduler_t *scheduler)
+{
+    scheduler_live_stats_t *stats = scheduler->live_stats;
+
+    if(stats == NULL)
+    {
+        return;
+    }
+
+    WRITE_ONCE(stats->sequence, stats->sequence + 1);
+    smp_wmb();
+    WRITE_ONCE(stats->sid, scheduler->sid);
+    WRITE_ONCE(stats->wid, scheduler->wid);
+    WRITE_ONCE(stats->state, scheduler->state);
+    WRITE_ONCE(stats->switch_count, scheduler->switch_count);
+    WRITE_ONCE(stats->switch_time, scheduler->switch_latency.total);
+    WRITE_ONCE(stats->last_switch_time, scheduler->time_of_the_last_switch);
+    smp_wmb();
+    WRITE_ONCE(stats->sequence, stats->sequence + 1);
+}
+
+/** @brief Makes the pthread a standby pthread of the completion list with a @p clid
+ *.
+ *  Standby pthreads are idle pthreads created by the UMS library that continue the execution of schedulers whose worker threads have blocked in the kernel.
+ *  To become a standby pthread:
+ *   - Checks if the process is already managed, if not returns @c UMS_ERROR_PROCESS_NOT_FOUND
+ *   - Checks if the completion list exists, if not returns @c UMS_ERROR_COMPLETION_LIST_NOT_FOUND
+ *   - Makes the pthread a @ref host by calling @ref get_current_host(), if it already runs a scheduler returns @c UMS_ERROR_STATE_RUNNING
+ *   - Saves current registers and FPU control words to host::home, the pthread returns to them when it stops running a scheduler
+ *   - Waits for a scheduler handed off to the completion list by calling @ref wait_for_handoff()
+ *   - Continues the execution of the scheduler by calling @ref take_over_scheduler()
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param clid Completion list ID
+ *  @return returns @c UMS_WORKER_BLOCKED to the scheduler that was taken over, @c UMS_SUCCESS if the completion list is finished or error constant if there are any errors
+ */
+int enter_standby(file_context_t *context, ums_clid_t clid)
+{
+    process_t *process;
+    completion_list_node_t *comp_list;
+    scheduler_t *scheduler;
+    host_t *host;
+    int ret;
+
+    process = get_current_process(context);
+    if(process == NULL)
+    {
+        return -UMS_ERROR_PROCESS_NOT_FOUND;
+    }
+
+    comp_list = check_if_completion_list_exists(process, clid);
+    if(comp_list == NULL)
+    {
+        return -UMS_ERROR_COMPLETION_LIST_NOT_FOUND;
+    }
+
+    host = get_current_host(context);
+    if(host == NULL)
+    {
+        return -UMS_ERROR;
+    }
+    if(host->scheduler != NULL)
+    {
+        return -UMS_ERROR_STATE_RUNNING;
+    }
+
+    save_context_regs(&host->home);
+    save_context_fpu(&host->home);
+
+    atomic_inc(&comp_list->standby_count);
+    ret = wait_for_handoff(comp_list, &scheduler);
+    atomic_dec(&comp_list->standby_count);
+
+    if(ret != UMS_SUCCESS)
+    {
+        return ret;
+    }
+    if(scheduler == NULL)
+    {
+        return UMS_SUCCESS;
+    }
+
+    take_over_scheduler(context, host, scheduler);
+
+    return UMS_WORKER_BLOCKED;
+}
+
+/** @brief Deletes the @ref host of the file that is being released
+ *.
+ *  If the file is released by the pthread itself, the host is stopped by @ref stop_host() and freed.
+ *  The host::notifier can only be unregistered by the pthread itself, thus if the file is released by another pthread while the host still runs a scheduler,
+ *  host::released is set under host_list::lock and the host is freed by @ref host_task_exit() when the pthread exits. The host keeps the module loaded meanwhile, since its' notifier calls into it.
+ *  Otherwise the host is not registered anymore and is freed right away.
+ *
+ *  @param host pointer to @ref host, can be @c NULL
+ *  @return returns @c UMS_SUCCESS or @c UMS_ERROR_STATE_RUNNING if the host is still in use, then the reference of the process held by the file is handed over to the host
+ */
+int delete_host(host_t *host)
+{
+    bool in_use;
+
+    if(host == NULL)
+    {
+        return UMS_SUCCESS;
+    }
+
+    if(host->task == current)
+    {
+        stop_host(host);
+        free_host(host);
+        return UMS_SUCCESS;
+    }
+
+    spin_lock(&host_list.lock);
+    in_use = host->scheduler != NULL;
+    host->released = in_use;
+    spin_unlock(&host_list.lock);
+
+    if(in_use)
+    {
+        __module_get(THIS_MODULE);
+        return -UMS_ERROR_STATE_RUNNING;
+    }
+    free_host(host);
+    return UMS_SUCCESS;
+}
+
+/** @brief Stops the @ref host from running a scheduler, called by the pthread itself
+ *.
+ *  Unregisters host::notifier and cancels host::park_timer. If the pthread is still the host of the scheduler, i.e. it was not handed off, scheduler::host is cleared
+ *  and scheduler::quantum_timer is cancelled synchronously, so that @ref quantum_expired() does not reach the host once it is freed.
+ *  host::scheduler is cleared and host::released is read under host_list::lock, which serializes it with @ref delete_host() called by another pthread:
+ *  either the file is released while the host is in use and the caller frees the host, or the host is freed by @ref delete_host().
+ *
+ *  @param host pointer to @ref host
+ *  @return returns @c true if the file of the host was released while it was in use, then the host has to be freed by the caller
+ */
+static bool stop_host(host_t *host)
+{
+    scheduler_t *scheduler = host->scheduler;
+    bool released;
+
+    if(scheduler == NULL)
+    {
+        return false;
+    }
+
+    preempt_notifier_unregister(&host->notifier);
+    hrtimer_cancel(&host->park_timer);
+    if(cmpxchg(&scheduler->host, host, NULL) == host)
+    {
+        hrtimer_cancel(&scheduler->quantum_timer);
+    }
+
+    spin_lock(&host_list.lock);
+    host->scheduler = NULL;
+    host->blocked_worker = NULL;
+    released = host->released;
+    spin_unlock(&host_list.lock);
+
+    return released;
+}
+
+/** @brief Removes the @ref host that is not registered anymore from host_list::table, frees it and drops the reference of its' task
+ *.
+ *
+ *  @param host pointer to @ref host
+ */
+static void free_host(host_t *host)
+{
+    spin_lock(&host_list.lock);
+    hash_del(&host->node);
+    spin_unlock(&host_list.lock);
+
+    put_task_struct(host->task);
+    kfree(host);
+}
+
+static struct preempt_ops host_preempt_ops = {
+    .sched_in = host_sched_in,
+    .sched_out = host_sched_out,
+};
+
+/** @brief Called when any task exits to stop the @ref host of the exiting pthread
+ *.
+ *  The call is made by the exiting task itself, before its' files are closed, thus the host::notifier still registered on it can be unregistered.
+ *  The hosts of the task that run a scheduler are looked up in host_list::table by its' pid, a pthread that opened several files may have several hosts.
+ *  Stops each of them by calling @ref stop_host(). If the file of the host has been released already (host::released is set),
+ *  frees the host, drops the reference of its' process and the reference of the module taken by @ref delete_host().
+ *  The module cannot be unloaded before the notifier returns, since @ref unregister_host_exit() waits for the running notifiers.
+ *
+ *  @param nb host_exit_notifier
+ *  @param action @c PROFILE_TASK_EXIT
+ *  @param data task that exits, which is current
+ *  @return returns @c NOTIFY_OK if the task was a host, otherwise @c NOTIFY_DONE
+ */
+static int host_task_exit(struct notifier_block *nb, unsigned long action, void *data)
+{
+    host_t *host, *temp;
+    process_t *process;
+    int ret = NOTIFY_DONE;
+
+    for(;;)
+    {
+        host = NULL;
+        spin_lock(&host_list.lock);
+        hash_for_each_possible(host_list.table, temp, node, current->pid)
+        {
+            if(temp->task == current && temp->scheduler != NULL)
+            {
+                host = temp;
+                break;
+            }
+        }
+        spin_unlock(&host_list.lock);
+
+        if(host == NULL)
+        {
+            return ret;
+        }
+        ret = NOTIFY_OK;
+
+        if(stop_host(host))
+        {
+            process = host->process;
+            free_host(host);
+            put_process(process);
+            module_put(THIS_MODULE);
+        }
+    }
+}
+
+static struct notifier_block host_exit_notifier = {
+    .notifier_call = host_task_exit,
+};
+
+/** @brief Registers @ref host_task_exit() to be called when a task exits
+ *.
+ *  There is no hook on the exit of a single task exported to modules other than the profiling notifier of @c PROFILE_TASK_EXIT, which requires @c CONFIG_PROFILING.
+ *
+ *  @return returns @c UMS_SUCCESS when succesful or @c -UMS_ERROR if the notifier cannot be registered
+ */
+int register_host_exit(void)
+{
+    return profile_event_register(PROFILE_TASK_EXIT, &host_exit_notifier) == 0 ? UMS_SUCCESS : -UMS_ERROR;
+}
+
+/** @brief Unregisters @ref host_task_exit(), waiting for the calls that are running
+ *.
+ *
+ */
+void unregister_host_exit(void)
+{
+    profile_event_unregister(PROFILE_TASK_EXIT, &host_exit_notifier);
+}
+
+/** @brief Publishes the worker thread that became idle in completion_list_node::ready_ring
+ *.
+ *  Called under completion_list_node::lock, which serializes the producers. The entry is dropped if the ring is full.
+ *
+ *  @param comp_list pointer to @ref completion_list_node
+ *  @param wid Worker ID
+ */
+static void publish_ready_worker(completion_list_node_t *comp_list, ums_wid_t wid)
+{
+    ready_ring_t *ring = comp_list->ready_ring;
+    unsigned int tail = ring->tail;
+
+    if(tail - READ_ONCE(ring->head) >= UMS_READY_RING_SLOTS)
+    {
+        return;
+    }
+
+    WRITE_ONCE(ring->wids[tail & (UMS_READY_RING_SLOTS - 1)], wid);
+    smp_store_release(&ring->tail, tail + 1);
+}
+
+/** @brief Checks if the completion list has idle worker threads or all of its' worker threads have finished
+ *.
+ *  The counters are read without completion_list_node::lock, the result is confirmed by @ref dequeue_completion_list_items()
+ *
+ *  @param comp_list pointer to @ref completion_list_node
+ *  @return returns @c true if the scheduler waiting on the completion list has to proceed
+ */
+static bool completion_list_has_items(completion_list_node_t *comp_list)
+{
+    return READ_ONCE(comp_list->idle_list->worker_count) != 0 || READ_ONCE(comp_list->finished_count) == READ_ONCE(comp_list->worker_count);
+}
+
+/** @brief Spins until the completion list has items or scheduler::spin_threshold nanoseconds have passed
+ *.
+ *  Spinning stops early if the pthread has to be rescheduled
+ *
+ *  @param scheduler pointer to @ref scheduler
+ *  @param comp_list pointer to @ref completion_list_node
+ *  @return returns @c true if the completion list has items
+ */
+static bool spin_on_completion_list(scheduler_t *scheduler, completion_list_node_t *comp_list)
+{
+    u64 start = ktime_get_ns();
+
+    while(!completion_list_has_items(comp_list))
+    {
+        if(need_resched() || ktime_get_ns() - start >= scheduler->spin_threshold)
+        {
+            return false;
+        }
+        cpu_relax();
+    }
+    return true;
+}
+
+/** @brief Sleeps on completion_list_node::wait_queue until the completion list has items
+ *.
+ *  The wait is exclusive, so that a paused worker thread wakes up a single scheduler
+ *
+ *  @param comp_list pointer to @ref completion_list_node
+ *  @param timeout timeout in jiffies or @c MAX_SCHEDULE_TIMEOUT
+ *  @return returns the remaining timeout, 0 if it has expired or @c -ERESTARTSYS if interrupted by a signal
+ */
+static long sleep_on_completion_list(completion_list_node_t *comp_list, long timeout)
+{
+    DEFINE_WAIT(wait);
+
+    for(;;)
+    {
+        prepare_to_wait_exclusive(&comp_list->wait_queue, &wait, TASK_INTERRUPTIBLE);
+        if(completion_list_has_items(comp_list) || timeout == 0)
+        {
+            break;
+        }
+        if(signal_pending(current))
+        {
+            timeout = -ERESTARTSYS;
+            break;
+        }
+        timeout = schedule_timeout(timeout);
+    }
+    finish_wait(&comp_list->wait_queue, &wait);
+
+    return timeout;
+}
+
+/** @brief Adapts the time the scheduler spins before sleeping
+ *.
+ *  The threshold is doubled (at least to @c UMS_MIN_SPIN_THRESHOLD) if spinning pays off and halved otherwise, it never exceeds scheduler::spin_limit
+ *
+ *  @param scheduler pointer to @ref scheduler
+ *  @param grow @c true if worker threads became available within scheduler::spin_limit
+ */
+static void adapt_spin_threshold(scheduler_t *scheduler, bool grow)
+{
+    if(grow)
+    {
+        scheduler->spin_threshold = min(max(scheduler->spin_threshold * 2, (u64)UMS_MIN_SPIN_THRESHOLD), scheduler->spin_limit);
+    }
+    else
+    {
+        scheduler->spin_threshold /= 2;
+    }
+}
+
+/** @brief Moves idle worker threads of another completion list of the process to the completion list of the @p scheduler
+ *.
+ *   - The completion list with the most idle worker threads is chosen under process::lock (the counters are read without completion_list_node::lock)
+ *   - Both completion lists are locked in the order of their IDs, so that schedulers stealing from each other do not deadlock
+ *   - At most scheduler::steal_batch and at most half (rounded up) of the idle worker threads are moved from the head of the idle list of the victim to the tail of the own one,
+ *     worker::clid and the counters of both completion lists (also in their completion_list_node::ready_ring) are updated.
+ *     The entries of the stolen worker threads left in the ring of the victim are dropped by @ref claim_worker(), since their completion list does not match
+ *   - If the victim became finished, its' sleeping schedulers and standby pthreads are woken up
+ *   - Records the statistics related to work stealing
+ *
+ *  @param scheduler pointer to @ref scheduler
+ *  @return returns the number of worker threads that were moved
+ */
+static unsigned int steal_workers(scheduler_t *scheduler)
+{
+    process_t *process = scheduler->process;
+    completion_list_node_t *comp_list = scheduler->comp_list;
+    completion_list_node_t *victim = NULL;
+    completion_list_node_t *first;
+    completion_list_node_t *second;
+    completion_list_node_t *temp;
+    worker_t *worker = NULL;
+    worker_t *safe_temp = NULL;
+    unsigned int idle = 0;
+    unsigned int batch;
+    unsigned int count = 0;
+    bool finished;
+
+    scheduler->steal_attempts++;
+
+    spin_lock(&process->lock);
+    list_for_each_entry(temp, &process->completion_lists->list, list)
+    {
+        if(temp != comp_list && READ_ONCE(temp->idle_list->worker_count) > idle)
+        {
+            victim = temp;
+            idle = READ_ONCE(temp->idle_list->worker_count);
+        }
+    }
+    spin_unlock(&process->lock);
+
+    if(victim == NULL)
+    {
+        return 0;
+    }
+
+    first = comp_list->clid < victim->clid ? comp_list : victim;
+    second = first == comp_list ? victim : comp_list;
+    spin_lock(&first->lock);
+    spin_lock_nested(&second->lock, SINGLE_DEPTH_NESTING);
+
+    batch = min(scheduler->steal_batch, (victim->idle_list->worker_count + 1) / 2);
+    list_for_each_entry_safe(worker, safe_temp, &victim->idle_list->list, local_list)
+    {
+        if(count >= batch) break;
+        worker->clid = comp_list->clid;
+        xa_erase(&victim->workers, worker->wid);
+        xa_store(&comp_list->workers, worker->wid, worker, GFP_ATOMIC);
+        list_move_tail(&(worker->local_list), &comp_list->idle_list->list);
+        count++;
+    }
+    victim->idle_list->worker_count -= count;
+    victim->worker_count -= count;
+    comp_list->idle_list->worker_count += count;
+    comp_list->worker_count += count;
+    update_peak_idle_count(comp_list);
+    WRITE_ONCE(victim->ready_ring->worker_count, victim->worker_count);
+    WRITE_ONCE(comp_list->ready_ring->worker_count, comp_list->worker_count);
+    finished = count != 0 && victim->finished_count == victim->worker_count;
+
+    spin_unlock(&second->lock);
+    spin_unlock(&first->lock);
+
+    if(finished)
+    {
+        wake_up_interruptible_all(&victim->wait_queue);
+        wake_up_interruptible_all(&victim->standby_wait);
+    }
+
+    if(count != 0)
+    {
+        scheduler->steal_successes++;
+        scheduler->stolen_workers += count;
+        trace_ums_steal(scheduler->pid, scheduler->sid, comp_list->clid, count, IDLE);
+    }
+    return count;
+}
+
+/** @brief Retrieves the @ref host of the pthread that issues the call through the @p context, it is allocated on the first call
+ *.
+ *  A new host is added to host_list::table, so that @ref host_task_exit() finds it when the pthread exits
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @return returns pointer to @ref host, or @c NULL if it cannot be allocated or belongs to another pthread
+ */
+static host_t *get_current_host(file_context_t *context)
+{
+    host_t *host = context->host;
+
+    if(host != NULL)
+    {
+        return host->task == current ? host : NULL;
+    }
+
+    host = kzalloc(sizeof(host_t), GFP_KERNEL);
+    if(host == NULL)
+    {
+        return NULL;
+    }
+    get_task_struct(current);
+    host->task = current;
+    host->process = context->process;
+    preempt_notifier_init(&host->notifier, &host_preempt_ops);
+    hrtimer_init(&host->park_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL_PINNED);
+    host->park_timer.function = park_expired;
+
+    spin_lock(&host_list.lock);
+    hash_add(host_list.table, &host->node, current->pid);
+    spin_unlock(&host_list.lock);
+
+    context->host = host;
+    return host;
+}
+
+/** @brief Called when the pthread running a scheduler is scheduled in
+ *.
+ *  Adds the time the pthread was off CPU to worker::off_cpu_time of the worker thread it was running when it was switched out.
+ *  scheduler::quantum_timer is pinned, since @ref quantum_expired() has to interrupt the pthread. If the pthread has migrated to another CPU, or the timer expired while it was switched out,
+ *  the timer is re-armed on the current CPU with its' expiry time.
+ *  If the worker thread has blocked in the kernel, the blocking call is likely to have completed, thus host::park_timer is armed to park the pthread by @ref park_expired()
+ *  once the worker thread returns to the user space.
+ *
+ *  @param notifier host::notifier
+ *  @param cpu CPU the pthread is scheduled in
+ */
+static void host_sched_in(struct preempt_notifier *notifier, int cpu)
+{
+    host_t *host = container_of(notifier, host_t, notifier);
+    scheduler_t *scheduler = host->scheduler;
+    worker_t *worker = host->off_cpu_worker;
+
+    if(worker != NULL)
+    {
+        worker->off_cpu_time += ktime_get_ns() - host->sched_out_time;
+        host->off_cpu_worker = NULL;
+    }
+    if(scheduler != NULL && scheduler->worker != NULL && host->blocked_worker == NULL && !host->in_ioctl &&
+       READ_ONCE(scheduler->comp_list->quantum) != 0 &&
+       (scheduler->quantum_cpu != cpu || !hrtimer_is_queued(&scheduler->quantum_timer)))
+    {
+        scheduler->quantum_cpu = cpu;
+        hrtimer_start_expires(&scheduler->quantum_timer, HRTIMER_MODE_ABS_PINNED);
+    }
+    if(host->blocked_worker != NULL && !host->in_ioctl)
+    {
+        hrtimer_start(&host->park_timer, ns_to_ktime(UMS_PARK_DELAY), HRTIMER_MODE_REL_PINNED);
+    }
+}
+
+/** @brief Detects the worker thread run by the scheduler blocking in the kernel
+ *.
+ *  Called by the kernel scheduler with runqueue lock held when the pthread is switched out, thus it only records the state and defers the rest to scheduler::irq_work.
+ *  If the pthread runs a worker thread, the time it is switched out is recorded in host::sched_out_time, so that @ref host_sched_in() accounts the time off CPU to the worker thread.
+ *  If the pthread goes to sleep, i.e. it has been dequeued from the runqueue (@c on_rq is cleared) rather than merely preempted, outside of ioctl calls of UMS device while it runs a worker thread, and there are standby pthreads of the completion list:
+ *   - Records the worker thread in host::blocked_worker, the pthread continues the worker thread once the system call completes and is parked by @ref park_host() on its' next switch call
+ *   - Queues scheduler::irq_work, that hands off the scheduler to a standby pthread by calling @ref hand_off_scheduler()
+ *
+ *  @param notifier host::notifier
+ *  @param next task that is switched to
+ */
+static void host_sched_out(struct preempt_notifier *notifier, struct task_struct *next)
+{
+    host_t *host = container_of(notifier, host_t, notifier);
+    scheduler_t *scheduler = host->scheduler;
+    worker_t *worker;
+
+    worker = host->blocked_worker != NULL ? host->blocked_worker : (scheduler != NULL ? scheduler->worker : NULL);
+    if(worker != NULL)
+    {
+        host->off_cpu_worker = worker;
+        host->sched_out_time = ktime_get_ns();
+    }
+
+    if(READ_ONCE(current->on_rq) || host->in_ioctl || host->blocked_worker != NULL || (current->flags & PF_EXITING))
+    {
+        return;
+    }
+    if(scheduler == NULL || scheduler->worker == NULL || atomic_read(&scheduler->comp_list->standby_count) == 0)
+    {
+        return;
+    }
+
+    worker = scheduler->worker;
+    host->blocked_worker = worker;
+    trace_ums_block(scheduler->pid, scheduler->sid, worker->wid, scheduler->comp_list->clid, RUNNING);
+    irq_work_queue(&scheduler->irq_work);
+}
+
+/** @brief Adds the scheduler whose worker thread has blocked to completion_list_node::handoff_list and wakes up a standby pthread
+ *.
+ *  Runs once the runqueue lock is released. Cancels scheduler::quantum_timer first, the FPU control words of the scheduler were already saved by @ref run_worker().
+ *
+ *  @param work scheduler::irq_work
+ */
+static void hand_off_scheduler(struct irq_work *work)
+{
+    scheduler_t *scheduler = container_of(work, scheduler_t, irq_work);
+    completion_list_node_t *comp_list = scheduler->comp_list;
+
+    hrtimer_try_to_cancel(&scheduler->quantum_timer);
+
+    spin_lock(&comp_list->standby_lock);
+    list_add_tail(&scheduler->handoff_list, &comp_list->handoff_list);
+    spin_unlock(&comp_list->standby_lock);
+
+    wake_up_interruptible(&comp_list->standby_wait);
+}
+
+/** @brief Called when host::park_timer expires to park the pthread whose worker thread has blocked in the kernel
+ *.
+ *  There is no hook on the return from an arbitrary system call exported to modules, thus the timer armed by @ref host_sched_in() polls the pthread instead.
+ *  Runs in hard interrupt context: if the pthread is interrupted in the user space, i.e. the blocking call has completed, @c UMS_PREEMPT_SIGNAL is sent to it,
+ *  whose handler calls @ref preempt_thread() that parks the pthread by calling @ref park_host(). If the pthread is still in the kernel, the timer is restarted after @c UMS_PARK_DELAY.
+ *  The timer is not restarted if the pthread is not running, it is armed again when the pthread is scheduled in.
+ *
+ *  @param timer host::park_timer
+ *  @return returns @c HRTIMER_RESTART if the pthread is still in the kernel, otherwise @c HRTIMER_NORESTART
+ */
+static enum hrtimer_restart park_expired(struct hrtimer *timer)
+{
+    host_t *host = container_of(timer, host_t, park_timer);
+    struct pt_regs *regs = get_irq_regs();
+
+    if(host->blocked_worker == NULL || host->task != current)
+    {
+        return HRTIMER_NORESTART;
+    }
+    if(regs == NULL || !user_mode(regs))
+    {
+        hrtimer_forward_now(timer, ns_to_ktime(UMS_PARK_DELAY));
+        return HRTIMER_RESTART;
+    }
+
+    if(!test_and_set_bit(0, &host->park_pending))
+    {
+        send_sig(UMS_PREEMPT_SIGNAL, current, 1);
+    }
+    return HRTIMER_NORESTART;
+}
+
+/** @brief Parks the pthread whose worker thread has blocked, once the worker thread is back in the user space
+ *.
+ *  The scheduler is run by a standby pthread meanwhile, while the pthread continues the worker thread after the blocking call.
+ *  The pthread is parked by @ref preempt_thread() called by the handler of @c UMS_PREEMPT_SIGNAL sent by @ref park_expired(),
+ *  or by the switch call of the worker thread (@ref thread_yield(), @ref switch_to_thread() or @ref thread_yield_to()) if it comes first:
+ *   - Unregisters host::notifier and cancels host::park_timer, the pthread is not the host of the scheduler anymore
+ *   - Records the execution time of the worker thread and saves its' compact context, so that the switch call returns @c UMS_SUCCESS when the worker thread is executed next time
+ *   - Switches to host::home, the call that made the pthread the host returns @c UMS_HOST_PARKED, so that the pthread becomes a standby pthread
+ *   - Returns the worker thread to the completion list with the @p status of the switch call by calling @ref release_worker() (the worker becomes visible to other schedulers only after its' registers were saved)
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param status value of @ref worker_status, which is the status of the worker thread
+ *  @return returns @c true if the pthread was parked, @c false if its' worker thread has not blocked
+ */
+static bool park_host(file_context_t *context, worker_status_t status)
+{
+    host_t *host = context->host;
+    scheduler_t *scheduler;
+    worker_t *worker;
+
+    if(host == NULL || host->task != current || host->blocked_worker == NULL)
+    {
+        return false;
+    }
+
+    scheduler = host->scheduler;
+    worker = host->blocked_worker;
+
+    preempt_notifier_unregister(&host->notifier);
+    hrtimer_cancel(&host->park_timer);
+    host->scheduler = NULL;
+
+    account_worker_time(worker);
+
+    save_worker_context(worker);
+    load_context_regs(&host->home);
+    load_context_fpu(&host->home);
+
+    host->blocked_worker = NULL;
+    release_worker(scheduler, worker, status);
+    return true;
+}
+
+/** @brief Waits on completion_list_node::standby_wait until a scheduler is handed off to the completion list or it is finished
+ *.
+ *  The wait is exclusive, so that a handed off scheduler wakes up a single standby pthread
+ *
+ *  @param comp_list pointer to @ref completion_list_node
+ *  @param scheduler pointer where the handed off @ref scheduler is stored, or @c NULL if the completion list is finished
+ *  @return returns @c UMS_SUCCESS or @c -ERESTARTSYS if interrupted by a signal
+ */
+static int wait_for_handoff(completion_list_node_t *comp_list, scheduler_t **scheduler)
+{
+    scheduler_t *temp = NULL;
+    int ret = UMS_SUCCESS;
+    DEFINE_WAIT(wait);
+
+    for(;;)
+    {
+        prepare_to_wait_exclusive(&comp_list->standby_wait, &wait, TASK_INTERRUPTIBLE);
+
+        spin_lock_irq(&comp_list->standby_lock);
+        temp = list_first_entry_or_null(&comp_list->handoff_list, scheduler_t, handoff_list);
+        if(temp != NULL)
         {
-            kern_params->workers[count] = temp->wid;
-            count++;
-            if (count > comp_list->worker_count) break;
+            list_del_init(&temp->handoff_list);
+        }
+        spin_unlock_irq(&comp_list->standby_lock);
+
+        if(temp != NULL || READ_ONCE(comp_list->finished_count) == READ_ONCE(comp_list->worker_count))
+        {
+            break;
+        }
+        if(signal_pending(current))
+        {
+            ret = -ERESTARTSYS;
+            break;
         }
+        schedule();
     }
+    finish_wait(&comp_list->standby_wait, &wait);
 
-    kern_params->worker_count = count;
+    *scheduler = temp;
+    return ret;
+}
 
-    ret = copy_to_user(params, kern_params, sizeof(list_params_t) + comp_list->worker_count * sizeof(ums_wid_t));
-    if(ret != 0)
+/** @brief Continues the execution of the @p scheduler handed off to the standby pthread
+ *.
+ *   - The scheduler does not run a worker thread anymore, the worker thread that has blocked is returned to the completion list by @ref park_host()
+ *   - The scheduler is bound to the pthread: scheduler::pid is set to @c current->pid and the scheduler is bound to the @p context
+ *   - Registers host::notifier of the pthread
+ *   - Performs a context switch to scheduler::context, the call of the scheduler that executed the blocked worker thread returns @c UMS_WORKER_BLOCKED
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param host pointer to @ref host of the pthread
+ *  @param scheduler pointer to @ref scheduler
+ */
+static void take_over_scheduler(file_context_t *context, host_t *host, scheduler_t *scheduler)
+{
+    scheduler->pid = current->pid;
+    scheduler->wid = -1;
+    scheduler->worker = NULL;
+    scheduler->state = IDLE;
+    publish_scheduler_stats(scheduler);
+    WRITE_ONCE(context->scheduler, scheduler);
+    trace_ums_handoff(scheduler->pid, scheduler->sid, scheduler->comp_list->clid);
+
+    host->scheduler = scheduler;
+    WRITE_ONCE(scheduler->host, host);
+    preempt_notifier_register(&host->notifier);
+
+    load_context_regs(&scheduler->context);
+    load_context_fpu(&scheduler->context);
+    scheduler->fpu_saved = false;
+    scheduler->fpu_check_armed = false;
+}
+
+/** @brief Switches the pthread from the worker thread run by the @p scheduler back to the scheduler
+ *.
+ *   - Cancels scheduler::quantum_timer
+ *   - Records the statistics related to the worker, such as total execution time
+ *   - Saves the compact context of the worker thread and performs a context switch without holding any lock, since the worker is owned by the scheduler.
+ *     FPU state of the scheduler is restored only if it was saved, i.e. a worker thread that uses FPU was run since the scheduler was switched from
+ *     The call of the scheduler that executed the worker thread returns @c UMS_SUCCESS
+ *   - Returns the worker thread to the completion list by calling @ref release_worker() (the worker becomes visible to other schedulers only after its' registers were saved)
+ *
+ *  @param scheduler pointer to @ref scheduler
+ *  @param status value of @ref worker_status, which is the status of the worker thread
+ */
+static void return_to_scheduler(scheduler_t *scheduler, worker_status_t status)
+{
+    worker_t *worker = scheduler->worker;
+
+    hrtimer_try_to_cancel(&scheduler->quantum_timer);
+    account_worker_time(worker);
+
+    check_worker_fpu(scheduler, worker);
+    save_worker_context(worker);
+    load_context_regs(&scheduler->context);
+    task_pt_regs(current)->ax = UMS_SUCCESS;
+    if(scheduler->fpu_saved)
     {
-        printk(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: dequeue_completion_list_items(): copy_to_user failed to copy %d bytes\n", ret);
-        kfree(kern_params);
-        return ret;
+        load_context_fpu(&scheduler->context);
+        scheduler->fpu_saved = false;
     }
 
-    kfree(kern_params);
+    scheduler->wid = -1;
+    scheduler->worker = NULL;
+    scheduler->state = IDLE;
+    publish_scheduler_stats(scheduler);
+
+    release_worker(scheduler, worker, status);
+}
+
+/** @brief Called when the time quantum of the worker thread run by the scheduler expires
+ *.
+ *  Runs in hard interrupt context, thus the worker thread is not preempted here: @c UMS_PREEMPT_SIGNAL is sent to the pthread running the scheduler,
+ *  whose handler installed by the UMS library calls @ref preempt_thread(). The kernel saves all the registers of the worker thread to the signal frame on its' stack,
+ *  thus the worker thread is suspended at an arbitrary instruction without the module saving them.
+ *  The signal is sent only if the pthread is interrupted in the user space and no signal sent before is pending (scheduler::preempt_pending):
+ *  a signal would interrupt the system call or the ioctl call of UMS device the worker thread is in, thus otherwise the timer is restarted for another time quantum.
+ *  If the pthread is switched out or runs on another CPU, the timer is not restarted here: @ref host_sched_in() re-arms it on the CPU of the pthread.
+ *
+ *  @param timer scheduler::quantum_timer
+ *  @return returns @c HRTIMER_RESTART if the preemption is retried, otherwise @c HRTIMER_NORESTART, the timer is armed again by the next switch to a worker thread
+ */
+static enum hrtimer_restart quantum_expired(struct hrtimer *timer)
+{
+    scheduler_t *scheduler = container_of(timer, scheduler_t, quantum_timer);
+    host_t *host = READ_ONCE(scheduler->host);
+    struct pt_regs *regs = get_irq_regs();
+    u64 quantum;
+
+    if(host == NULL || host->blocked_worker != NULL)
+    {
+        return HRTIMER_NORESTART;
+    }
+
+    if(host->task != current)
+    {
+        return HRTIMER_NORESTART;
+    }
+    if(regs == NULL || !user_mode(regs) || test_and_set_bit(0, &scheduler->preempt_pending))
+    {
+        quantum = READ_ONCE(scheduler->comp_list->quantum);
+        if(quantum == 0)
+        {
+            return HRTIMER_NORESTART;
+        }
+        hrtimer_forward_now(timer, ns_to_ktime(quantum));
+        return HRTIMER_RESTART;
+    }
+
+    scheduler->preempt_switch = scheduler->switch_count;
+    send_sig(UMS_PREEMPT_SIGNAL, current, 1);
+    return HRTIMER_NORESTART;
+}
+
+/** @brief Preempts the worker thread whose time quantum has expired, called by the handler of @c UMS_PREEMPT_SIGNAL of the UMS library
+ *.
+ *  If the worker thread run by the pthread has blocked in the kernel and is back in the user space (see @ref park_expired()), the pthread is parked by calling @ref park_host()
+ *  and the call returns @c UMS_HOST_PARKED to the call that made the pthread the host, as if the worker thread has paused in the handler.
+ *  The call returns @c UMS_PREEMPT_NOT_PENDING if no preemption is signalled to the pthread, so that the handler passes the signal on to the handler of the application.
+ *  The preemption is dropped and the call returns @c UMS_PREEMPT_STALE, so that the handler returns, if it is stale: the pthread does not run the scheduler anymore,
+ *  the worker thread has blocked in the kernel or the scheduler has switched to another worker thread since the time quantum expired.
+ *  Neither of them is recorded as the latency of a switch.
+ *  Otherwise increments worker::quantum_expirations and switches back to the scheduler by calling @ref return_to_scheduler(), as if the worker thread has paused in the handler.
+ *  When the worker thread is executed next time, the call returns @c UMS_SUCCESS to the handler, whose return restores the registers of the worker thread from the signal frame.
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @return returns @c UMS_SUCCESS when succesful, @c UMS_HOST_PARKED if the pthread was parked, @c UMS_PREEMPT_STALE or @c UMS_PREEMPT_NOT_PENDING if the preemption is dropped
+ */
+int preempt_thread(file_context_t *context)
+{
+    scheduler_t *scheduler;
+    host_t *host = context->host;
+    bool park_pending = false;
+
+    if(host != NULL && host->task == current)
+    {
+        park_pending = test_and_clear_bit(0, &host->park_pending);
+        if(park_host(context, PAUSE))
+        {
+            return UMS_HOST_PARKED;
+        }
+    }
+
+    if(get_current_scheduler(context, &scheduler) != UMS_SUCCESS || !test_and_clear_bit(0, &scheduler->preempt_pending))
+    {
+        return park_pending ? UMS_PREEMPT_STALE : UMS_PREEMPT_NOT_PENDING;
+    }
+    if(host == NULL || host->task != current || host->scheduler != scheduler || host->blocked_worker != NULL)
+    {
+        return UMS_PREEMPT_STALE;
+    }
+    if(scheduler->worker == NULL || scheduler->switch_count != scheduler->preempt_switch)
+    {
+        return UMS_PREEMPT_STALE;
+    }
+
+    scheduler->worker->quantum_expirations++;
+    trace_ums_preempt(scheduler->pid, scheduler->sid, scheduler->wid, scheduler->comp_list->clid, IDLE);
+    return_to_scheduler(scheduler, PAUSE);
+
+    return UMS_SUCCESS;
+}
+
+/** @brief Retrieves the @ref scheduler run by the calling pthread
+ *.
+ *  The scheduler bound to the @p context by @ref enter_scheduling_mode() is used directly when it is run by the calling pthread, thus no lookup is performed.
+ *  Otherwise (e.g. the file is shared by several pthreads) the process and the scheduler are looked up and bound to the @p context for the following calls.
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param scheduler pointer where the found @ref scheduler is stored
+ *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
+ */
+static int get_current_scheduler(file_context_t *context, scheduler_t **scheduler)
+{
+    process_t *process;
+    scheduler_t *cached;
+
+    cached = READ_ONCE(context->scheduler);
+    if(cached != NULL && cached->pid == current->pid && cached->tid == current->tgid)
+    {
+        *scheduler = cached;
+        return UMS_SUCCESS;
+    }
+
+    process = get_current_process(context);
+    if(process == NULL)
+    {
+        return -UMS_ERROR_PROCESS_NOT_FOUND;
+    }
+
+    cached = check_if_scheduler_exists_run_by(process, current->pid);
+    if(cached == NULL)
+    {
+        return -UMS_ERROR_SCHEDULER_NOT_FOUND;
+    }
+
+    WRITE_ONCE(context->scheduler, cached);
+    *scheduler = cached;
     return UMS_SUCCESS;
 }
 
 /** @brief Checks if @p process with @p pid is managed by the UMS kernel module
  *.
+ *  Only the bucket of process_list::table that @p pid hashes to is searched, under @c rcu_read_lock() and without taking process_list::lock,
+ *  thus the cost of the lookup does not depend on the number of processes handled by the UMS kernel module
  * 
  *  @param pid pid of the process
  *  @return returns pointer to @ref process, or @c NULL if no process was found
@@ -704,26 +2563,51 @@ int dequeue_completion_list_items(list_params_t *params)
 process_t *check_if_process_exists(pid_t pid)
 {
     process_t *process = NULL;
+    process_t *temp = NULL;
 
-    if(!list_empty(&process_list.list))
+    rcu_read_lock();
+    hash_for_each_possible_rcu(process_list.table, temp, node, pid)
     {
-        process_t *temp = NULL;
-        process_t *safe_temp = NULL;
-        list_for_each_entry_safe(temp, safe_temp, &process_list.list, list) 
+        if(temp->pid == pid)
         {
-            if(temp->pid == pid)
-            {
-                process = temp;
-                break;
-            }
+            process = temp;
+            break;
+        }
+    }
+    rcu_read_unlock();
+
+    return process;
+}
+
+/** @brief Looks up @p process with @p pid like @ref check_if_process_exists() and takes a reference of it
+ *.
+ *  The reference is taken under @c rcu_read_lock(), thus it fails only if the last reference of the process is being dropped
+ * 
+ *  @param pid pid of the process
+ *  @return returns pointer to @ref process that has to be released by @ref put_process(), or @c NULL if no process was found
+ */
+process_t *get_process(pid_t pid)
+{
+    process_t *process = NULL;
+    process_t *temp = NULL;
+
+    rcu_read_lock();
+    hash_for_each_possible_rcu(process_list.table, temp, node, pid)
+    {
+        if(temp->pid == pid && kref_get_unless_zero(&temp->refcount))
+        {
+            process = temp;
+            break;
         }
     }
+    rcu_read_unlock();
 
     return process;
 }
 
 /** @brief Checks if completion list with @p clid was created by a @p process
  *.
+ *  The search is performed under process::lock
  * 
  *  @param process pointer to @ref process
  *  @param clid Completion list ID
@@ -731,8 +2615,9 @@ process_t *check_if_process_exists(pid_t pid)
  */
 completion_list_node_t *check_if_completion_list_exists(process_t *process, ums_clid_t clid)
 {
-    completion_list_node_t *comp_list;
+    completion_list_node_t *comp_list = NULL;
 
+    spin_lock(&process->lock);
     if(!list_empty(&process->completion_lists->list))
     {
         completion_list_node_t *temp = NULL;
@@ -746,12 +2631,14 @@ completion_list_node_t *check_if_completion_list_exists(process_t *process, ums_
             }
         }
     }
+    spin_unlock(&process->lock);
   
     return comp_list;
 }
 
 /** @brief Checks if scheduler with @p sid was created by a @p process
  *.
+ *  The search is performed under process::lock
  * 
  *  @param process pointer to @ref process
  *  @param sid Scheduler ID
@@ -759,8 +2646,9 @@ completion_list_node_t *check_if_completion_list_exists(process_t *process, ums_
  */
 scheduler_t *check_if_scheduler_exists(process_t *process, ums_sid_t sid)
 {
-    scheduler_t *scheduler;
+    scheduler_t *scheduler = NULL;
 
+    spin_lock(&process->lock);
     if(!list_empty(&process->scheduler_list->list))
     {
         scheduler_t *temp = NULL;
@@ -774,94 +2662,53 @@ scheduler_t *check_if_scheduler_exists(process_t *process, ums_sid_t sid)
             }
         }
     }
+    spin_unlock(&process->lock);
   
-    return scheduler;
-}
-
-/** @brief Checks if scheduler with @p pid was created by a @p process
- *.
- * 
- *  @param process pointer to @ref process
- *  @param pid pid of the pthread which is associated with scheduler
- *  @return returns pointer to @ref scheduler, or @c NULL if no scheduler was found
- */
-scheduler_t *check_if_scheduler_exists_run_by(process_t *process, pid_t pid)
-{
-    scheduler_t *scheduler;
-
-    if(!list_empty(&process->scheduler_list->list))
-    {
-        scheduler_t *temp = NULL;
-        scheduler_t *safe_temp = NULL;
-        list_for_each_entry_safe(temp, safe_temp, &process->scheduler_list->list, list) 
-        {
-            if(temp->pid == pid)
-            {
-                scheduler = temp;
-                break;
-            }
-        }
-    }
-  
-    return scheduler;
-}
-
-/** @brief Checks if worker thread with @p wid exists in @p worker_list of the completion list
- *.
- * Search is performed using local_list member of @ref worker 
- * 
- *  @param worker_list pointer to @ref worker_list
- *  @param wid Worker ID
- *  @return returns pointer to @ref worker, or @c NULL if no worker was found
- */
-worker_t *check_if_worker_exists(worker_list_t *worker_list, ums_wid_t wid)
-{
-    worker_t *worker;
-
-    if(!list_empty(&worker_list->list))
-    {
-        worker_t *temp = NULL;
-        worker_t *safe_temp = NULL;
-        list_for_each_entry_safe(temp, safe_temp, &worker_list->list, local_list) 
-        {
-            if(temp->wid == wid)
-            {
-                worker = temp;
-                break;
-            }
-        }
-    }
-  
-    return worker;
+    return scheduler;
 }
 
-/** @brief Checks if worker thread with @p wid exists in @p worker_list of the process
+/** @brief Checks if scheduler with @p pid was created by a @p process
  *.
- * Search is performed using global_list member of @ref worker
- *  
- *  @param worker_list pointer to @ref worker_list
- *  @param wid Worker ID
- *  @return returns pointer to @ref worker, or @c NULL if no worker was found
+ *  The search is performed under process::lock
+ * 
+ *  @param process pointer to @ref process
+ *  @param pid pid of the pthread which is associated with scheduler
+ *  @return returns pointer to @ref scheduler, or @c NULL if no scheduler was found
  */
-worker_t *check_if_worker_exists_global(worker_list_t *worker_list, ums_wid_t wid)
+scheduler_t *check_if_scheduler_exists_run_by(process_t *process, pid_t pid)
 {
-    worker_t *worker;
+    scheduler_t *scheduler = NULL;
 
-    if(!list_empty(&worker_list->list))
+    spin_lock(&process->lock);
+    if(!list_empty(&process->scheduler_list->list))
     {
-        worker_t *temp = NULL;
-        worker_t *safe_temp = NULL;
-        list_for_each_entry_safe(temp, safe_temp, &worker_list->list, global_list) 
+        scheduler_t *temp = NULL;
+        scheduler_t *safe_temp = NULL;
+        list_for_each_entry_safe(temp, safe_temp, &process->scheduler_list->list, list) 
         {
-            if(temp->wid == wid)
+            if(temp->pid == pid)
             {
-                worker = temp;
+                scheduler = temp;
                 break;
             }
         }
     }
+    spin_unlock(&process->lock);
   
-    return worker;
+    return scheduler;
+}
+
+/** @brief Checks if worker thread with @p wid was created by a @p process
+ *.
+ *  The worker thread is retrieved from process::workers, thus the lookup does not depend on the number of worker threads and does not take any lock
+ *  
+ *  @param process pointer to @ref process
+ *  @param wid Worker ID
+ *  @return returns pointer to @ref worker, or @c NULL if no worker was found
+ */
+worker_t *check_if_worker_exists(process_t *process, ums_wid_t wid)
+{
+    return xa_load(&process->workers, wid);
 }
 
 /** @brief Checks if schedulers of the process have finished their work
@@ -874,6 +2721,7 @@ state_t check_schedulers_state(process_t *process)
 {
     state_t progress = FINISHED;
 
+    spin_lock(&process->lock);
     if(!list_empty(&process->scheduler_list->list))
     {
         scheduler_t *temp = NULL;
@@ -889,67 +2737,30 @@ state_t check_schedulers_state(process_t *process)
 
         }
     }
+    spin_unlock(&process->lock);
     return progress;
 }
 
-/** @brief Deletes @ref process from the global @ref process_list 
+/** @brief Deletes all data structures of the @p process
  *.
- *  The function was used during early phases of development and later was left unused,
- *  since proc entries of the process are linked to @ref process (in case user wants to see statistics, the data should be available for read), it was decided that only kernel module can delete data structures allocated for the process
- *  Therefore @ref delete_process_safe() is used to delete @ref process 
- *  Still the function performs a check to see if all schedulers have finished their job and then performs series of deletions of all data structures used by the process
+ *  Called by @ref free_process() when the last reference of the process is dropped, or by @ref cleanup() when UMS kernel module exits.
+ *  The process is not in process_list::table anymore and its' proc entries were removed, thus nothing can reach the data structures being deleted.
+ *  The process itself is freed after RCU grace period, since lookups in process_list::table may still see it.
+ *  The deletion is traced once per process by @c ums_delete, rather than logged per object, since a process can have millions of worker threads.
  *
  *  @param process pointer to @ref process 
  *  @return returns @c UMS_SUCCESS if succesful 
  */
 int delete_process(process_t *process)
 {
-    int ret;
-    state_t progress = check_schedulers_state(process);
-
-    if(progress != FINISHED)
-    {
-        ret = -UMS_ERROR_STATE_RUNNING;
-        printk(KERN_INFO UMS_MODULE_NAME_LOG "--- Error: delete_process() => Schedulers are still running.\n");
-        goto out;
-    }
-
-    delete_completion_lists_and_worker_threads(process);
-    //delete_workers_from_process_list(process->worker_list);
-    delete_schedulers(process);
-    list_del(&process->list);
-    process_list.process_count--;
-    kfree(process->proc_entry);
-    kfree(process);
-    ret = UMS_SUCCESS;
-
- out:
-    return ret;
-}
-
-/** @brief Called by UMS kernel module when module exits to delete @ref process from the global @ref process_list 
- *.
- *  The function does not perform a check to see if all schedulers have finished their job to delete data structures used by the process
- *  It is assumed that all work has been done, therefore user issued a command to UMS kernel module to exit
- *
- *  @param process pointer to @ref process 
- *  @return returns @c UMS_SUCCESS if succesful 
- */
-int delete_process_safe(process_t *process)
-{
-    int ret;
-
+    trace_ums_delete(process->pid);
     delete_completion_lists_and_worker_threads(process);
-    //delete_workers_from_process_list(process->worker_list);
     delete_schedulers(process);
-    list_del(&process->list);
-    process_list.process_count--;
     kfree(process->proc_entry);
-    kfree(process);
-    ret = UMS_SUCCESS;
+    vfree(process->stats_page);
+    kfree_rcu(process, rcu);
 
- out:
-    return ret;
+    return UMS_SUCCESS;
 }
 
 /** @brief Deletes completion lists and worker threads created by the process 
@@ -967,20 +2778,22 @@ int delete_completion_lists_and_worker_threads(process_t *process)
         completion_list_node_t *safe_temp = NULL;
         list_for_each_entry_safe(temp, safe_temp, &process->completion_lists->list, list) 
         {
-            printk(KERN_INFO UMS_MODULE_NAME_LOG "--- Completion list:%d was deleted.\n", temp->clid);
-
             if(temp->idle_list->worker_count > 0) delete_workers_from_completion_list(temp->idle_list);
             if(temp->busy_list->worker_count > 0) delete_workers_from_completion_list(temp->busy_list);
             kfree(temp->idle_list);
             kfree(temp->busy_list);
+            vfree(temp->ready_ring);
+            xa_destroy(&temp->workers);
+            kfree(temp->proc_entry);
             list_del(&temp->list);
-            kfree(temp);
+            kmem_cache_free(completion_list_cache, temp);
         }
     }
     list_del(&process->completion_lists->list);
     kfree(process->completion_lists);
     delete_workers_from_process_list(process->worker_list);
     kfree(process->worker_list);
+    xa_destroy(&process->workers);
     return UMS_SUCCESS;
 }
 
@@ -998,106 +2811,570 @@ int delete_workers_from_completion_list(worker_list_t *worker_list)
         worker_t *safe_temp = NULL;
         list_for_each_entry_safe(temp, safe_temp, &worker_list->list, local_list) 
         {
-            printk(KERN_INFO UMS_MODULE_NAME_LOG "--- Worker thread:%d was deleted.\n", temp->wid);
             list_del(&temp->local_list);
             list_del(&temp->global_list);
+            kmem_cache_free(worker_cache, temp);
+        }
+    }
+    return UMS_SUCCESS;
+}
+
+/** @brief Deletes worker threads created by the process
+ *.
+ *  Frees allocated memory that was used by the worker threads
+ *
+ *  @param worker_list pointer to @ref worker_list of the @ref process 
+ *  @return returns @c UMS_SUCCESS if succesful 
+ */
+int delete_workers_from_process_list(worker_list_t *worker_list)
+{
+    if(!list_empty(&worker_list->list))
+    {
+        worker_t *temp = NULL;
+        worker_t *safe_temp = NULL;
+        list_for_each_entry_safe(temp, safe_temp, &worker_list->list, global_list) 
+        {
+            list_del(&temp->global_list);
+            kmem_cache_free(worker_cache, temp);
+        }
+    }
+    return UMS_SUCCESS;
+}
+
+/** @brief Deletes schedulers created by the process
+ *.
+ *  Frees allocated memory that was used by the schedulers
+ *  
+ *  @param process pointer to @ref process 
+ *  @return returns @c UMS_SUCCESS if succesful 
+ */
+int delete_schedulers(process_t *process)
+{
+
+    if(!list_empty(&process->scheduler_list->list))
+    {
+        scheduler_t *temp = NULL;
+        scheduler_t *safe_temp = NULL;
+        list_for_each_entry_safe(temp, safe_temp, &process->scheduler_list->list, list) 
+        {
+            list_del(&temp->list);
+            hrtimer_cancel(&temp->quantum_timer);
+            irq_work_sync(&temp->irq_work);
+            kfree(temp->fpu_check);
             kfree(temp->proc_entry);
-            kfree(temp);
+            kmem_cache_free(scheduler_cache, temp);
+        }
+    }
+    list_del(&process->scheduler_list->list);
+    kfree(process->scheduler_list);
+    return UMS_SUCCESS;
+}
+
+/** @brief Performs a cleanup by deleting all the allocated data structures for all processes that were managed by the UMS kernel module
+ *.
+ *  No UMS device is opened and no @ref host outlives its' file when UMS kernel module exits, since both hold a reference of the module,
+ *  thus the processes left are only expected if a reference was leaked. All proc entries were already removed by @ref delete_proc().
+ * 
+ *  @return returns @c UMS_SUCCESS if succesful 
+ */
+int cleanup()
+{
+    process_t *temp = NULL;
+    process_t *safe_temp = NULL;
+    struct hlist_node *safe_node = NULL;
+    int bkt;
+
+    hash_for_each_safe(process_list.table, bkt, safe_node, temp, node)
+    {
+        hash_del_rcu(&temp->node);
+        process_list.process_count--;
+        delete_process(temp);
+    }
+    list_for_each_entry_safe(temp, safe_temp, &process_list.released, list)
+    {
+        list_del(&temp->list);
+        delete_process(temp);
+    }
+    rcu_barrier();
+
+    return UMS_SUCCESS;
+}
+
+/** @brief Creates the slab caches of worker threads, schedulers and completion lists
+ *.
+ *  Each object type gets its' own cache named after it (@c ums_worker, @c ums_scheduler, @c ums_completion_list), thus the objects are packed by their real size instead of the next kmalloc size class, allocations are served from per-CPU slabs and the usage is reported in @c /proc/slabinfo.
+ *  Objects are aligned to cache lines so that the locks and counters of one object do not share a cache line with a neighbouring object updated by another CPU.
+ *  The caches have no constructors: a constructor runs only when a slab is populated, and objects have to be returned to the cache in the constructed state,
+ *  while every field of the objects is set per creation (IDs, counters, contexts, list links) and a scheduler is zeroed on allocation, which a constructor is not compatible with.
+ *  The extended state saved with XSAVE is sized to @c fpu_kernel_xstate_size, which has to fit the @c fpu snapshots of scheduler::fpu_check taken in the debug mode.
+ *
+ *  @return returns @c UMS_SUCCESS when succesful or @c -UMS_ERROR if any of the caches cannot be created
+ */
+int init_caches(void)
+{
+    if(fpu_kernel_xstate_size > sizeof(union fpregs_state))
+    {
+        printk(KERN_ERR UMS_MODULE_NAME_LOG "--- Error: init_caches() => extended state of %u bytes is not supported\n", fpu_kernel_xstate_size);
+        return -UMS_ERROR;
+    }
+
+    worker_cache = kmem_cache_create("ums_worker", sizeof(worker_t), 0, SLAB_HWCACHE_ALIGN | SLAB_ACCOUNT, NULL);
+    scheduler_cache = kmem_cache_create("ums_scheduler", sizeof(scheduler_t), __alignof__(scheduler_t), SLAB_HWCACHE_ALIGN | SLAB_ACCOUNT, NULL);
+    completion_list_cache = kmem_cache_create("ums_completion_list", sizeof(completion_list_node_t), 0, SLAB_HWCACHE_ALIGN | SLAB_ACCOUNT, NULL);
+    if(worker_cache == NULL || scheduler_cache == NULL || completion_list_cache == NULL)
+    {
+        delete_caches();
+        return -UMS_ERROR;
+    }
+    return UMS_SUCCESS;
+}
+
+/** @brief Destroys the slab caches created by @ref init_caches()
+ *.
+ *  Has to be called after @ref cleanup(), when all the objects are returned to the caches
+ */
+void delete_caches(void)
+{
+    kmem_cache_destroy(worker_cache);
+    kmem_cache_destroy(scheduler_cache);
+    kmem_cache_destroy(completion_list_cache);
+    worker_cache = NULL;
+    scheduler_cache = NULL;
+    completion_list_cache = NULL;
+}
+
+/** @brief Computes time difference between passed @p prev_time and current time, which is used in this case as an indicator of execution time for @ref worker and @ref scheduler
+ *.
+ *  The monotonic clock is used, so that the result is not affected by the changes of the wall-clock time
+ *
+ *  @param prev_time member of @ref worker and @ref scheduler, monotonic time in nanoseconds
+ *  @return returns unsigned long
+ */
+unsigned long get_exec_time(u64 prev_time)
+{
+    return ktime_get_ns() - prev_time;
+}
+
+/** @brief Accounts the time the @p worker has run since it was run by @ref run_worker(), called by the pthread running it when it is switched from the worker thread
+ *.
+ *  The execution time is the monotonic time elapsed since the switch, less the time the pthread was off CPU meanwhile, thus preemption or blocking of the pthread is not billed to the worker thread.
+ *  User and system CPU time are the differences of @c utime and @c stime of the pthread, whose precision depends on the CPU time accounting of the kernel (ticks by default).
+ *
+ *  @param worker pointer to @ref worker
+ */
+static void account_worker_time(worker_t *worker)
+{
+    unsigned long wall_time = get_exec_time(worker->time_of_the_last_switch);
+    unsigned long off_cpu_time = worker->off_cpu_time - worker->off_cpu_at_switch;
+
+    worker->total_exec_time += wall_time > off_cpu_time ? wall_time - off_cpu_time : 0;
+    worker->user_time += current->utime - worker->utime_at_switch;
+    worker->system_time += current->stime - worker->stime_at_switch;
+}
+
+/** @brief Records the @p latency of the context switch performed by the scheduler bound to the @p context
+ *.
+ *  Called by the ioctl handler of UMS device for the switch commands (@c UMS_EXECUTE_THREAD, @c UMS_THREAD_YIELD, @c UMS_SWITCH_TO, @c UMS_THREAD_YIELD_TO),
+ *  thus the latency covers the whole call from its' entry to the return, rather than the copying of the registers only.
+ *  Updates the last, total and average switch time and scheduler::switch_latency by calling @ref record_latency(), then publishes them by calling @ref publish_scheduler_stats().
+ *  The statistics are owned by the pthread running the scheduler, thus no lock is held.
+ *
+ *  @param context pointer to @ref file_context of the opened UMS device
+ *  @param latency monotonic time in nanoseconds from the entry to the return of the call
+ */
+void record_switch_latency(file_context_t *context, u64 latency)
+{
+    scheduler_t *scheduler = READ_ONCE(context->scheduler);
+
+    if(scheduler == NULL || scheduler->pid != current->pid)
+    {
+        return;
+    }
+
+    record_latency(&scheduler->switch_latency, latency);
+    scheduler->time_needed_for_the_last_switch = latency;
+    scheduler->total_time_needed_for_the_switch += latency;
+    scheduler->avg_switch_time = scheduler->total_time_needed_for_the_switch / scheduler->switch_latency.count;
+    publish_scheduler_stats(scheduler);
+}
+
+/** @brief Clears the @p histogram
+ *.
+ *
+ *  @param histogram pointer to @ref latency_histogram
+ */
+static void init_latency_histogram(latency_histogram_t *histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->min = U64_MAX;
+}
+
+/** @brief Records the @p latency in the @p histogram
+ *.
+ *  Updates the count, total, minimum and maximum latency and the log2 bucket of the latency. The caller serializes the updates of the histogram.
+ *
+ *  @param histogram pointer to @ref latency_histogram
+ *  @param latency latency in nanoseconds
+ */
+static void record_latency(latency_histogram_t *histogram, u64 latency)
+{
+    unsigned int bucket;
+
+    bucket = latency == 0 ? 0 : min_t(unsigned int, ilog2(latency), UMS_LATENCY_BUCKETS - 1);
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    histogram->total += latency;
+    if(latency < histogram->min)
+    {
+        histogram->min = latency;
+    }
+    if(latency > histogram->max)
+    {
+        histogram->max = latency;
+    }
+}
+
+/** @brief Estimates the @p percent percentile of the latencies recorded in the @p histogram
+ *.
+ *  The result is the upper bound of the bucket the percentile falls into, limited by the maximum latency, thus it overestimates the latency by less than a factor of two
+ *
+ *  @param histogram pointer to @ref latency_histogram
+ *  @param percent percentile to estimate, from 1 to 100
+ *  @return returns latency in nanoseconds, or 0 if no latency was recorded
+ */
+static u64 get_latency_percentile(latency_histogram_t *histogram, unsigned int percent)
+{
+    unsigned long rank, count = 0;
+    int i;
+
+    if(histogram->count == 0)
+    {
+        return 0;
+    }
+
+    rank = (histogram->count * percent + 99) / 100;
+    for(i = 0; i < UMS_LATENCY_BUCKETS - 1; i++)
+    {
+        count += histogram->buckets[i];
+        if(count >= rank)
+        {
+            return min_t(u64, (1ULL << (i + 1)) - 1, histogram->max);
+        }
+    }
+    return histogram->max;
+}
+
+/** @brief Shows the minimum, maximum, median and 99th percentile of the @p histogram and its' non-empty buckets, used by the proc entries
+ *.
+ *
+ *  @param m seq_file of the proc entry
+ *  @param name description of the latency, e.g. "time needed for the worker thread switch"
+ *  @param histogram pointer to @ref latency_histogram
+ */
+static void show_latency_histogram(struct seq_file *m, const char *name, latency_histogram_t *histogram)
+{
+    int i;
+
+    seq_printf(m, "Minimum %s: %llu\n", name, histogram->count != 0 ? histogram->min : 0);
+    seq_printf(m, "Maximum %s: %llu\n", name, histogram->max);
+    seq_printf(m, "Median (p50) %s: %llu\n", name, get_latency_percentile(histogram, 50));
+    seq_printf(m, "99th percentile (p99) of %s: %llu\n", name, get_latency_percentile(histogram, 99));
+    seq_printf(m, "Histogram of %s:\n", name);
+    for(i = 0; i < UMS_LATENCY_BUCKETS; i++)
+    {
+        if(histogram->buckets[i] == 0)
+        {
+            continue;
+        }
+        if(i == UMS_LATENCY_BUCKETS - 1)
+        {
+            seq_printf(m, "  >= %llu ns: %lu\n", 1ULL << i, histogram->buckets[i]);
         }
+        else
+        {
+            seq_printf(m, "  %llu - %llu ns: %lu\n", i == 0 ? 0 : 1ULL << i, (1ULL << (i + 1)) - 1, histogram->buckets[i]);
+        }
+    }
+}
+
+/** @brief Samples the @p rate of the events of the completion list
+ *.
+ *  The events counted since the last sample are averaged over @p elapsed time (in microseconds, so that the product does not overflow), then the sample is folded into event_rate::rate once per
+ *  elapsed @ref UMS_RATE_INTERVAL, so that the rate decays over the intervals in which the completion list was not sampled.
+ *
+ *  @param rate pointer to @ref event_rate
+ *  @param elapsed time in nanoseconds since the last sample
+ *  @param intervals number of elapsed intervals, at least 1
+ */
+static void update_event_rate(event_rate_t *rate, u64 elapsed, unsigned int intervals)
+{
+    u64 sample;
+
+    sample = div64_u64((u64)(rate->count - rate->sampled_count) * UMS_RATE_SCALE * USEC_PER_SEC, div_u64(elapsed, NSEC_PER_USEC));
+    while(intervals-- > 0)
+    {
+        rate->rate = rate->rate - (rate->rate >> UMS_RATE_WEIGHT_SHIFT) + (sample >> UMS_RATE_WEIGHT_SHIFT);
+    }
+    rate->sampled_count = rate->count;
+}
+
+/** @brief Samples the rates of executions, pauses and finishes of the @p comp_list if at least @ref UMS_RATE_INTERVAL has elapsed since the last sample
+ *.
+ *  Called under completion_list_node::lock by the paths that count the events and by the proc entry of the completion list.
+ *  The weight of a sample decays by a factor of 2^@ref UMS_RATE_WEIGHT_SHIFT / (2^@ref UMS_RATE_WEIGHT_SHIFT - 1) per interval,
+ *  thus at most 64 intervals are folded, after which older samples have no weight left.
+ *
+ *  @param comp_list pointer to @ref completion_list_node
+ *  @param now current monotonic time in nanoseconds
+ */
+static void update_completion_list_rates(completion_list_node_t *comp_list, u64 now)
+{
+    u64 elapsed;
+    unsigned int intervals;
+
+    if(now < comp_list->rate_time + UMS_RATE_INTERVAL)
+    {
+        return;
+    }
+
+    elapsed = now - comp_list->rate_time;
+    intervals = min_t(u64, div64_u64(elapsed, UMS_RATE_INTERVAL), 64);
+    update_event_rate(&comp_list->executes, elapsed, intervals);
+    update_event_rate(&comp_list->pauses, elapsed, intervals);
+    update_event_rate(&comp_list->finishes, elapsed, intervals);
+    comp_list->rate_time = now;
+}
+
+/** @brief Records the number of worker threads in the idle list of the @p comp_list as completion_list_node::peak_idle_count if it is the largest so far
+ *.
+ *  Called under completion_list_node::lock whenever worker threads are added to the idle list.
+ *
+ *  @param comp_list pointer to @ref completion_list_node
+ */
+static void update_peak_idle_count(completion_list_node_t *comp_list)
+{
+    if(comp_list->idle_list->worker_count > comp_list->peak_idle_count)
+    {
+        comp_list->peak_idle_count = comp_list->idle_list->worker_count;
+    }
+}
+
+/** @brief Saves the registers of the thread that is suspended by a call of the UMS library to the compact @p context
+ *.
+ *  Caller-saved registers are not preserved across the call by the calling convention, thus they are not saved.
+ *
+ *  @param context pointer to @ref compact_context
+ */
+static void save_context_regs(compact_context_t *context)
+{
+    struct pt_regs *regs = task_pt_regs(current);
+
+    context->ip = regs->ip;
+    context->sp = regs->sp;
+    context->bp = regs->bp;
+    context->bx = regs->bx;
+    context->r12 = regs->r12;
+    context->r13 = regs->r13;
+    context->r14 = regs->r14;
+    context->r15 = regs->r15;
+    context->di = regs->di;
+    context->flags = regs->flags;
+}
+
+/** @brief Loads the registers of the compact @p context, so that the pthread continues the execution of its' thread on return to the user space
+ *.
+ *  The thread is always suspended by a call of the UMS library, thus it does not expect the caller-saved registers to be preserved.
+ *  They are cleared instead of being left with the values of the thread that was switched from, so that they are not visible to the thread that is switched to.
+ *  regs::ax is overwritten by the return value of the ioctl call. regs::cx and regs::r11 mirror the instruction pointer and the flags, so that the kernel can return to the user space with @c sysret.
+ *
+ *  @param context pointer to @ref compact_context
+ */
+static void load_context_regs(compact_context_t *context)
+{
+    struct pt_regs *regs = task_pt_regs(current);
+
+    regs->ip = context->ip;
+    regs->sp = context->sp;
+    regs->bp = context->bp;
+    regs->bx = context->bx;
+    regs->r12 = context->r12;
+    regs->r13 = context->r13;
+    regs->r14 = context->r14;
+    regs->r15 = context->r15;
+    regs->di = context->di;
+    regs->flags = context->flags;
+    regs->cx = context->ip;
+    regs->r11 = context->flags;
+    regs->ax = 0;
+    regs->dx = 0;
+    regs->si = 0;
+    regs->r8 = 0;
+    regs->r9 = 0;
+    regs->r10 = 0;
+}
+
+/** @brief Saves FPU control words to the compact @p context
+ *.
+ *  The rest of the FPU state is not preserved across a call by the calling convention. The control words are read from the FPU registers with @c fpregs_lock() held,
+ *  which are loaded first if they were saved by the kernel during a previous preemption.
+ *
+ *  @param context pointer to @ref compact_context
+ */
+static void save_context_fpu(compact_context_t *context)
+{
+    fpregs_lock();
+    if(test_thread_flag(TIF_NEED_FPU_LOAD))
+    {
+        switch_fpu_return();
     }
-    return UMS_SUCCESS;
+    asm volatile("stmxcsr %0" : "=m" (context->mxcsr));
+    asm volatile("fnstcw %0" : "=m" (context->fcw));
+    fpregs_unlock();
 }
 
-/** @brief Deletes worker threads created by the process
+/** @brief Loads FPU control words of the compact @p context into the FPU registers
  *.
- *  Frees allocated memory that was used by the worker threads
  *
- *  @param worker_list pointer to @ref worker_list of the @ref process 
- *  @return returns @c UMS_SUCCESS if succesful 
+ *  @param context pointer to @ref compact_context
  */
-int delete_workers_from_process_list(worker_list_t *worker_list)
+static void load_context_fpu(compact_context_t *context)
 {
-    if(!list_empty(&worker_list->list))
+    fpregs_lock();
+    if(test_thread_flag(TIF_NEED_FPU_LOAD))
     {
-        worker_t *temp = NULL;
-        worker_t *safe_temp = NULL;
-        list_for_each_entry_safe(temp, safe_temp, &worker_list->list, global_list) 
-        {
-            printk(KERN_INFO UMS_MODULE_NAME_LOG "--- Worker thread:%d was deleted.\n", temp->wid);
-            list_del(&temp->global_list);
-            kfree(temp->proc_entry);
-            kfree(temp);
-        }
+        switch_fpu_return();
     }
-    return UMS_SUCCESS;
+    asm volatile("ldmxcsr %0" : : "m" (context->mxcsr));
+    asm volatile("fldcw %0" : : "m" (context->fcw));
+    fpregs_unlock();
 }
 
-/** @brief Deletes schedulers created by the process
+/** @brief Saves the registers of the worker thread that is suspended by a call of the UMS library to its' compact context worker::context
  *.
- *  Frees allocated memory that was used by the schedulers
- *  
- *  @param process pointer to @ref process 
- *  @return returns @c UMS_SUCCESS if succesful 
+ *  Saves the registers by @ref save_context_regs() and FPU control words by @ref save_context_fpu(), unless the worker thread is created with @ref UMS_WORKER_NO_FPU.
+ *  The time spent is added to worker::regs_switch_time and worker::fpu_switch_time.
+ *
+ *  @param worker pointer to @ref worker
  */
-int delete_schedulers(process_t *process)
+static void save_worker_context(worker_t *worker)
 {
+    u64 start, regs_saved;
 
-    if(!list_empty(&process->scheduler_list->list))
+    start = ktime_get_ns();
+    save_context_regs(&worker->context);
+    regs_saved = ktime_get_ns();
+
+    if(!(worker->flags & UMS_WORKER_NO_FPU))
     {
-        scheduler_t *temp = NULL;
-        scheduler_t *safe_temp = NULL;
-        list_for_each_entry_safe(temp, safe_temp, &process->scheduler_list->list, list) 
-        {
-            printk(KERN_INFO UMS_MODULE_NAME_LOG "--- Scheduler:%d was deleted.\n", temp->sid);
-            list_del(&temp->list);
-            kfree(temp->proc_entry);
-            kfree(temp);
-        }
+        save_context_fpu(&worker->context);
     }
-    list_del(&process->scheduler_list->list);
-    kfree(process->scheduler_list);
-    return UMS_SUCCESS;
+
+    worker->regs_switch_time += regs_saved - start;
+    worker->fpu_switch_time += ktime_get_ns() - regs_saved;
 }
 
-/** @brief Performs a cleanup by deleting all the allocated data structures for all processes that were managed by the UMS kernel module
+/** @brief Loads the registers of the @p worker, so that the pthread continues the execution of the worker thread on return to the user space
  *.
- *  
- * 
- *  @return returns @c UMS_SUCCESS if succesful 
+ *  Loads the registers by @ref load_context_regs() and FPU control words by @ref load_context_fpu(), unless the worker thread is created with @ref UMS_WORKER_NO_FPU.
+ *  The remaining registers are not expected to be preserved by the worker thread: it is always suspended by a call of the UMS library,
+ *  a preempted one in the handler of @c UMS_PREEMPT_SIGNAL, which restores the rest from the signal frame.
+ *
+ *  @param worker pointer to @ref worker
  */
-int cleanup()
+static void load_worker_context(worker_t *worker)
 {
+    u64 start, regs_loaded;
+
+    start = ktime_get_ns();
+    load_context_regs(&worker->context);
+    regs_loaded = ktime_get_ns();
+
+    if(!(worker->flags & UMS_WORKER_NO_FPU))
+    {
+        load_context_fpu(&worker->context);
+    }
 
-    if(!list_empty(&process_list.list))
+    worker->regs_switch_time += regs_loaded - start;
+    worker->fpu_switch_time += ktime_get_ns() - regs_loaded;
+}
+
+/** @brief Takes a snapshot of FPU state when a worker thread created with @ref UMS_WORKER_NO_FPU is run, if the debug mode is enabled by the @c debug_fpu module parameter
+ *.
+ *  The buffers of the snapshots are zeroed before saving, since XSAVEOPT and XSAVES do not write the components in their initial state.
+ *
+ *  @param scheduler pointer to @ref scheduler
+ *  @param worker pointer to @ref worker
+ */
+static void snapshot_worker_fpu(scheduler_t *scheduler, worker_t *worker)
+{
+    if(!READ_ONCE(debug_fpu) || !(worker->flags & UMS_WORKER_NO_FPU))
     {
-        process_t *temp = NULL;
-        process_t *safe_temp = NULL;
-        list_for_each_entry_safe(temp, safe_temp, &process_list.list, list) 
+        return;
+    }
+    if(scheduler->fpu_check == NULL)
+    {
+        scheduler->fpu_check = kmalloc_array(2, sizeof(struct fpu), GFP_KERNEL);
+        if(scheduler->fpu_check == NULL)
         {
-            delete_process_safe(temp);
+            return;
         }
     }
 
-    return UMS_SUCCESS;
+    memset(&scheduler->fpu_check[0].state, 0, fpu_kernel_xstate_size);
+    switch_fpu_regs(&scheduler->fpu_check[0], NULL);
+    scheduler->fpu_check_armed = true;
 }
 
-/** @brief Computes time difference between passed @p prev_time and current time, which is used in this case as an indicator of execution time for @ref worker and @ref scheduler
+/** @brief Compares FPU state with the snapshot taken by @ref snapshot_worker_fpu() when the worker thread is suspended, and reports the worker thread if it has modified FPU state
  *.
+ *  The check is performed when the worker thread pauses, switches or is preempted, but not when it blocks in the kernel, since the scheduler is handed off meanwhile.
  *
- *  @param prev_time member of @ref worker and @ref scheduler
- *  @return returns unsigned long
+ *  @param scheduler pointer to @ref scheduler
+ *  @param worker pointer to @ref worker
  */
-unsigned long get_exec_time(struct timespec64 *prev_time)
+static void check_worker_fpu(scheduler_t *scheduler, worker_t *worker)
 {
-    struct timespec64 current_time;
-    unsigned long cur, prev;
-
-    ktime_get_real_ts64(&current_time);
+    if(!scheduler->fpu_check_armed)
+    {
+        return;
+    }
+    scheduler->fpu_check_armed = false;
 
-    cur = current_time.tv_sec * 1000000000 + current_time.tv_nsec;
-    prev = prev_time->tv_sec * 1000000000 + prev_time->tv_nsec;
+    memset(&scheduler->fpu_check[1].state, 0, fpu_kernel_xstate_size);
+    switch_fpu_regs(&scheduler->fpu_check[1], NULL);
+    if(memcmp(&scheduler->fpu_check[0].state, &scheduler->fpu_check[1].state, fpu_kernel_xstate_size) != 0)
+    {
+        printk_ratelimited(KERN_WARNING UMS_MODULE_NAME_LOG "--- Warning: worker thread:%d is created with UMS_WORKER_NO_FPU, but has modified FPU state\n", worker->wid);
+    }
+}
 
-    return cur - prev;
+/** @brief Saves current FPU registers to @p save and then loads @p restore into FPU registers
+ *.
+ *  The complete extended state (AVX, AVX-512, etc.) is saved by the XSAVE helpers of the kernel. It is used only for the snapshots of scheduler::fpu_check in the debug mode,
+ *  contexts of worker threads, schedulers and hosts keep the FPU control words only (see @ref compact_context).
+ *  Since ioctl calls are not serialized by a global lock anymore, the calling thread can be preempted in the middle of the switch.
+ *  Therefore the switch is performed with @c fpregs_lock() held, and FPU registers of the current task are loaded first if they were saved by the kernel during a previous preemption.
+ *  Either of the parameters can be @c NULL to perform only a save or only a restore.
+ *
+ *  @param save pointer to @c fpu where current FPU registers are saved, or @c NULL
+ *  @param restore pointer to @c fpu that is loaded into FPU registers, or @c NULL
+ */
+static void switch_fpu_regs(struct fpu *save, struct fpu *restore)
+{
+    fpregs_lock();
+    if(test_thread_flag(TIF_NEED_FPU_LOAD))
+    {
+        switch_fpu_return();
+    }
+    if(save != NULL)
+    {
+        copy_fpregs_to_fpstate(save);
+    }
+    if(restore != NULL)
+    {
+        copy_kernel_to_fpregs(&restore->state);
+    }
+    fpregs_unlock();
 }
 
 /** @brief Initializes the core proc directory for UMS kernel module
@@ -1140,14 +3417,28 @@ static struct proc_ops scheduler_proc_file_ops = {
     .proc_open = scheduler_proc_open,
     .proc_read = seq_read,
     .proc_lseek = seq_lseek,
-    .proc_release = seq_release
+    .proc_release = single_release
+};
+
+static struct seq_operations scheduler_workers_seq_ops = {
+    .start = scheduler_workers_start,
+    .next = scheduler_workers_next,
+    .stop = scheduler_workers_stop,
+    .show = worker_proc_show
+};
+
+static struct seq_operations process_workers_seq_ops = {
+    .start = process_workers_start,
+    .next = process_workers_next,
+    .stop = process_workers_stop,
+    .show = process_workers_show
 };
 
-static struct proc_ops worker_proc_file_ops = {
-    .proc_open = worker_proc_open,
+static struct proc_ops completion_list_proc_file_ops = {
+    .proc_open = completion_list_proc_open,
     .proc_read = seq_read,
     .proc_lseek = seq_lseek,
-    .proc_release = seq_release
+    .proc_release = single_release
 };
 
 /** @brief Dinamically creates essential proc entries for the process
@@ -1155,6 +3446,8 @@ static struct proc_ops worker_proc_file_ops = {
  *  Allocates a memory for @ref process_proc_entry and initializes it:
  *      - Creates a folder to represent the process
  *      - Creates schedulers folder
+ *      - Creates completion_lists folder
+ *      - Creates workers file that lists the statistics of all worker threads of the process, one line per worker thread generated when it is read by @ref process_workers_seq_ops
  *
  *  @param process pointer to @ref process 
  *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
@@ -1187,6 +3480,18 @@ int create_process_proc_entry(process_t *process)
         return -UMS_ERROR_FAILED_TO_CREATE_PROC_ENTRY;
 	}
 
+    process_pe->comp_lists = proc_mkdir("completion_lists", process_pe->pde);
+    if (!process_pe->comp_lists) {
+		printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: create_process_proc_entry() => proc_mkdir() failed for Process:%d\n", process->pid);
+        return -UMS_ERROR_FAILED_TO_CREATE_PROC_ENTRY;
+	}
+
+    process_pe->workers = proc_create_seq_data("workers", S_IRUGO, process_pe->pde, &process_workers_seq_ops, process);
+    if (!process_pe->workers) {
+		printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: create_process_proc_entry() => proc_create_seq_data() failed for Process:%d\n", process->pid);
+        return -UMS_ERROR_FAILED_TO_CREATE_PROC_ENTRY;
+	}
+
     return UMS_SUCCESS;
 }
 
@@ -1194,9 +3499,9 @@ int create_process_proc_entry(process_t *process)
  *.
  *  Allocates a memory for @ref scheduler_proc_entry and initializes it:
  *      - Creates a folder to represent the scheduler
- *      - Creates info file that provides statistics about the scheduler
- *      - Creates workers folder of the completion list that is assigned to the scheduler
- *      - Creates proc entries for each worker thread by calling @ref create_worker_proc_entry()
+ *      - Creates info file that provides statistics about the scheduler, the scheduler is passed to it as the data of the proc entry
+ *      - Creates workers file that lists the worker threads of the completion list that is assigned to the scheduler.
+ *        Its' entries are generated when the file is read by @ref scheduler_workers_seq_ops, thus the cost does not depend on the number of worker threads
  *
  *  @param process pointer to @ref process
  *  @param scheduler pointer to @ref scheduler
@@ -1214,7 +3519,11 @@ int create_scheduler_proc_entry(process_t *process, scheduler_t *scheduler)
         return ret;
     }
 
-    scheduler_pe = kmalloc(sizeof(scheduler_proc_entry_t), GFP_KERNEL);
+    scheduler_pe = kzalloc(sizeof(scheduler_proc_entry_t), GFP_KERNEL);
+    if(scheduler_pe == NULL)
+    {
+        return -UMS_ERROR_FAILED_TO_CREATE_PROC_ENTRY;
+    }
     scheduler->proc_entry = scheduler_pe;
     scheduler_pe->parent = process->proc_entry->child;
     scheduler_pe->pde = proc_mkdir(buf, scheduler_pe->parent);
@@ -1223,149 +3532,113 @@ int create_scheduler_proc_entry(process_t *process, scheduler_t *scheduler)
         return -UMS_ERROR_FAILED_TO_CREATE_PROC_ENTRY;
 	}
 
-    scheduler_pe->child = proc_mkdir("workers", scheduler_pe->pde);
-    if (!scheduler_pe->child) {
-		printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: create_scheduler_proc_entry() => proc_mkdir() failed for Scheduler:%d\n", scheduler->sid);
+    scheduler_pe->workers = proc_create_seq_data("workers", S_IRUGO, scheduler_pe->pde, &scheduler_workers_seq_ops, scheduler);
+    if (!scheduler_pe->workers) {
+		printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: create_scheduler_proc_entry() => proc_create_seq_data() failed for Scheduler:%d\n", scheduler->sid);
         return -UMS_ERROR_FAILED_TO_CREATE_PROC_ENTRY;
 	}
 
-    scheduler_pe->info = proc_create("info", S_IALLUGO, scheduler_pe->pde, &scheduler_proc_file_ops);
+    scheduler_pe->info = proc_create_data("info", S_IALLUGO, scheduler_pe->pde, &scheduler_proc_file_ops, scheduler);
     if (!scheduler_pe->info) {
-		printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: create_scheduler_proc_entry() => proc_create() failed for Scheduler:%d\n", scheduler->sid);
+		printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: create_scheduler_proc_entry() => proc_create_data() failed for Scheduler:%d\n", scheduler->sid);
         return -UMS_ERROR_FAILED_TO_CREATE_PROC_ENTRY;
 	}
 
-    if(!list_empty(&scheduler->comp_list->idle_list->list))
-    {
-        worker_t *temp = NULL;
-        worker_t *safe_temp = NULL;
-        list_for_each_entry_safe(temp, safe_temp, &scheduler->comp_list->idle_list->list, local_list) 
-        {
-
-            create_worker_proc_entry(process, scheduler, temp);
- 
-        }   
-    }
+    return UMS_SUCCESS;
+}
 
-    if(!list_empty(&scheduler->comp_list->busy_list->list))
+/** @brief Removes the proc entries of the scheduler that failed to be created, together with the ones created before the failure
+ *.
+ *  The proc entries of published schedulers are removed together with the folder of the process by @ref delete_process_proc_entry() instead.
+ *
+ *  @param scheduler pointer to @ref scheduler
+ *  @return returns @c UMS_SUCCESS
+ */
+int delete_scheduler_proc_entry(scheduler_t *scheduler)
+{
+    if(scheduler->proc_entry != NULL)
     {
-        worker_t *temp = NULL;
-        worker_t *safe_temp = NULL;
-        list_for_each_entry_safe(temp, safe_temp, &scheduler->comp_list->busy_list->list, local_list) 
-        {
-
-            create_worker_proc_entry(process, scheduler, temp);
-
-        }
+        proc_remove(scheduler->proc_entry->pde);
+        kfree(scheduler->proc_entry);
+        scheduler->proc_entry = NULL;
     }
-
     return UMS_SUCCESS;
 }
 
-/** @brief Dinamically creates essential proc entries for the worker of the process
+/** @brief Dinamically creates essential proc entries for the completion list of the process
  *.
- *  Allocates a memory for @ref worker_proc_entry and initializes it:
- *      - Creates a file that provides statistics about the worker
+ *  Allocates a memory for @ref completion_list_proc_entry and initializes it:
+ *      - Creates a folder to represent the completion list
+ *      - Creates info file that provides statistics about the completion list, the completion list is passed to it as the data of the proc entry
  *
  *  @param process pointer to @ref process
- *  @param scheduler pointer to @ref scheduler
- *  @param worker pointer to @ref worker
+ *  @param comp_list pointer to @ref completion_list_node
  *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
  */
-int create_worker_proc_entry(process_t *process, scheduler_t *scheduler, worker_t *worker)
+int create_completion_list_proc_entry(process_t *process, completion_list_node_t *comp_list)
 {
-    worker_proc_entry_t *worker_pe;
+    completion_list_proc_entry_t *comp_list_pe;
     char buf[UMS_BUFFER_LEN];
 
-    int ret = snprintf(buf, UMS_BUFFER_LEN, "%d", worker->wid);
+    int ret = snprintf(buf, UMS_BUFFER_LEN, "%d", comp_list->clid);
     if(ret < 0)
     {
-        printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: create_worker_proc_entry() => snprintf() failed to copy %d bytes\n", ret);
+        printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: create_completion_list_proc_entry() => snprintf() failed to copy %d bytes\n", ret);
         return ret;
     }
 
-    worker_pe = kmalloc(sizeof(worker_proc_entry_t), GFP_KERNEL);
-    worker->proc_entry = worker_pe;
-    worker_pe->parent = scheduler->proc_entry->child;
+    comp_list_pe = kmalloc(sizeof(completion_list_proc_entry_t), GFP_KERNEL);
+    if(comp_list_pe == NULL)
+    {
+        return -UMS_ERROR_FAILED_TO_CREATE_PROC_ENTRY;
+    }
+    comp_list->proc_entry = comp_list_pe;
+    comp_list_pe->parent = process->proc_entry->comp_lists;
+    comp_list_pe->pde = proc_mkdir(buf, comp_list_pe->parent);
+    if (!comp_list_pe->pde) {
+        printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: create_completion_list_proc_entry() => proc_mkdir() failed for Completion list:%d\n", comp_list->clid);
+        return -UMS_ERROR_FAILED_TO_CREATE_PROC_ENTRY;
+    }
 
-    worker_pe->pde = proc_create(buf, S_IALLUGO, worker_pe->parent, &worker_proc_file_ops);
-    if (!worker_pe->pde) {
-        printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: create_worker_proc_entry() => proc_create() failed for Worker:%d\n", worker->wid);
+    comp_list_pe->info = proc_create_data("info", S_IALLUGO, comp_list_pe->pde, &completion_list_proc_file_ops, comp_list);
+    if (!comp_list_pe->info) {
+        printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: create_completion_list_proc_entry() => proc_create_data() failed for Completion list:%d\n", comp_list->clid);
         return -UMS_ERROR_FAILED_TO_CREATE_PROC_ENTRY;
     }
 
     return UMS_SUCCESS;
 }
 
-/** @brief Function that is used when opening info file inside the scheduler folder, it will eventually calls @c single_open()
+/** @brief Removes the proc entries of the process
  *.
+ *  The folder of the process is removed together with the entries of its' schedulers and completion lists,
+ *  @c proc_remove() waits until the files that are being read are closed, thus the data structures of the process can be deleted afterwards.
+ *  The memory used by @ref process_proc_entry and the entries of the schedulers and completion lists is freed together with the process by @ref delete_process().
  *
- *  @param inode
- *  @param file
- *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
+ *  @param process pointer to @ref process
+ *  @return returns @c UMS_SUCCESS
  */
-static int scheduler_proc_open(struct inode *inode, struct file *file)
+int delete_process_proc_entry(process_t *process)
 {
-    process_t *process;
-    scheduler_t *scheduler;
-    int pid, sid;
-
-    if (kstrtoint(file->f_path.dentry->d_parent->d_name.name, 10, &sid) != 0)
-    {
-        printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: scheduler_proc_open() => kstrtoul() failed for Scheduler:%d\n", sid);
-        return -UMS_ERROR_FAILED_TO_PROC_OPEN;
-    }
-    if (kstrtoint(file->f_path.dentry->d_parent->d_parent->d_parent->d_name.name, 10, &pid) != 0)
+    if(process->proc_entry != NULL)
     {
-        printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: scheduler_proc_open() => kstrtoul() failed for Process:%d\n", pid);
-        return -UMS_ERROR_FAILED_TO_PROC_OPEN;
+        proc_remove(process->proc_entry->pde);
     }
-
-    process = check_if_process_exists(pid);
-    scheduler = check_if_scheduler_exists(process, sid);
-
-    int ret = single_open(file, scheduler_proc_show, scheduler);
-
     return UMS_SUCCESS;
 }
 
-/** @brief Function that is used when opening worker file inside the workers folder of the scheduler, it will eventually calls @c single_open()
+/** @brief Function that is used when opening info file inside the scheduler folder, it will eventually calls @c single_open()
  *.
+ *  The scheduler is the data of the proc entry set by @ref create_scheduler_proc_entry(), thus no lookup is needed.
+ *  The entry is removed together with the folder of the process before the scheduler is deleted, which waits for the opened files
  *
  *  @param inode
  *  @param file
  *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
  */
-static int worker_proc_open(struct inode *inode, struct file *file)
+static int scheduler_proc_open(struct inode *inode, struct file *file)
 {
-    process_t *process;
-    worker_t *worker;
-    scheduler_t *scheduler;
-    int pid, sid, wid;
-
-    if (kstrtoint(file->f_path.dentry->d_name.name, 10, &wid) != 0)
-    {
-        printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: worker_proc_open() => kstrtoul() failed for Worker:%d\n", wid);
-        return -UMS_ERROR_FAILED_TO_PROC_OPEN;
-    }
-    if (kstrtoint(file->f_path.dentry->d_parent->d_parent->d_name.name, 10, &sid) != 0)
-    {
-        printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG "--- Error: worker_proc_open() => kstrtoul() failed for Scheduler:%d\n", sid);
-        return -UMS_ERROR_FAILED_TO_PROC_OPEN;
-    }
-    if (kstrtoint(file->f_path.dentry->d_parent->d_parent->d_parent->d_parent->d_name.name, 10, &pid) != 0)
-    {
-        printk(KERN_ALERT UMS_MODULE_NAME_LOG UMS_PROC_NAME_LOG" --- Error: worker_proc_open() => kstrtoul() failed for Process:%d\n", pid);
-        return -UMS_ERROR_FAILED_TO_PROC_OPEN;
-    }
-
-    process = check_if_process_exists(pid);
-    scheduler = check_if_scheduler_exists(process, sid);
-    worker = check_if_worker_exists_global(process->worker_list, wid);
-
-    int ret = single_open(file, worker_proc_show, worker);
-
-    return UMS_SUCCESS;
+    return single_open(file, scheduler_proc_show, PDE_DATA(inode));
 }
 
 /** @brief Shows the data/statistics of the @ref scheduler and used by @c single_open()
@@ -1377,6 +3650,7 @@ static int worker_proc_open(struct inode *inode, struct file *file)
 static int scheduler_proc_show(struct seq_file *m, void *p)
 {
     scheduler_t *scheduler = (scheduler_t*)m->private;
+
     seq_printf(m, "Scheduler id: %d\n", scheduler->sid);
     seq_printf(m, "Entry point: %p\n", (void*)scheduler->entry_point);
     seq_printf(m, "Completion list: %u\n", scheduler->comp_list->clid);
@@ -1384,6 +3658,11 @@ static int scheduler_proc_show(struct seq_file *m, void *p)
     seq_printf(m, "Time needed for the last worker thread switch: %lu\n", scheduler->time_needed_for_the_last_switch);
     seq_printf(m, "Total time needed for the worker thread switches: %lu\n", scheduler->total_time_needed_for_the_switch);
     seq_printf(m, "Average time needed for the worker thread switch: %lu\n", scheduler->avg_switch_time);
+    show_latency_histogram(m, "time needed for the worker thread switch", &scheduler->switch_latency);
+    seq_printf(m, "Work stealing batch: %u\n", scheduler->steal_batch);
+    seq_printf(m, "Number of work stealing attempts: %lu\n", scheduler->steal_attempts);
+    seq_printf(m, "Number of successful work stealing attempts: %lu\n", scheduler->steal_successes);
+    seq_printf(m, "Number of migrated worker threads: %lu\n", scheduler->stolen_workers);
     if(scheduler->state == IDLE) seq_printf(m, "Scheduler status is: IDLE.\n");
     else if(scheduler->state == RUNNING) seq_printf(m, "Scheduler status is: Running.\n");
 	else if(scheduler->state == FINISHED) seq_printf(m, "Scheduler status is: Finished.\n");
@@ -1391,24 +3670,258 @@ static int scheduler_proc_show(struct seq_file *m, void *p)
     return UMS_SUCCESS;
 }
 
-/** @brief Shows the data/statistics of the @ref worker and used by @c single_open()
+/** @brief Finds the first worker thread of the @p process whose ID is not less than @p pos
+ *.
+ *  Worker threads are looked up in process::workers in the order of their IDs, thus resuming the iteration takes a single lookup regardless of the number of worker threads.
+ *  The ID of the worker thread found is stored in @p pos, so that the iteration resumes after it, even if the set of worker threads changes between reads.
+ *
+ *  @param process pointer to @ref process
+ *  @param pos ID of the worker thread the lookup starts from
+ *  @return returns pointer to @ref worker or @c NULL if there are no more worker threads
+ */
+static worker_t *find_process_worker(process_t *process, loff_t *pos)
+{
+    unsigned long index = *pos;
+    worker_t *worker;
+
+    if(*pos > xa_limit_31b.max)
+    {
+        return NULL;
+    }
+
+    worker = xa_find(&process->workers, &index, ULONG_MAX, XA_PRESENT);
+    if(worker != NULL)
+    {
+        *pos = index;
+    }
+    return worker;
+}
+
+/** @brief Finds the first worker thread of the completion list of the @p scheduler whose ID is not less than @p pos
+ *.
+ *  Worker threads are looked up in completion_list_node::workers like @ref find_process_worker() does in process::workers,
+ *  thus reading the workers file costs a lookup per worker thread of the completion list, regardless of the number of worker threads of the process.
+ *
+ *  @param scheduler pointer to @ref scheduler
+ *  @param pos position of the workers file, i.e. the ID of the worker thread the lookup starts from
+ *  @return returns pointer to @ref worker or @c NULL if there are no more worker threads
+ */
+static worker_t *find_scheduler_worker(scheduler_t *scheduler, loff_t *pos)
+{
+    unsigned long index = *pos;
+    worker_t *worker;
+
+    if(*pos > xa_limit_31b.max)
+    {
+        return NULL;
+    }
+
+    worker = xa_find(&scheduler->comp_list->workers, &index, ULONG_MAX, XA_PRESENT);
+    if(worker != NULL)
+    {
+        *pos = index;
+    }
+    return worker;
+}
+
+/** @brief Starts or resumes the iteration over the worker threads of the workers file of the scheduler
+ *.
+ *  The scheduler is the data of the proc entry set by @ref create_scheduler_proc_entry()
+ *
+ *  @return returns pointer to @ref worker or @c NULL if there are no more worker threads
+ */
+static void *scheduler_workers_start(struct seq_file *m, loff_t *pos)
+{
+    return find_scheduler_worker(PDE_DATA(file_inode(m->file)), pos);
+}
+
+/** @brief Advances the iteration over the worker threads of the workers file of the scheduler to the worker thread after @p v
+ *.
+ *
+ *  @return returns pointer to @ref worker or @c NULL if there are no more worker threads
+ */
+static void *scheduler_workers_next(struct seq_file *m, void *v, loff_t *pos)
+{
+    (*pos)++;
+    return find_scheduler_worker(PDE_DATA(file_inode(m->file)), pos);
+}
+
+/** @brief Ends the iteration over the worker threads of the workers file of the scheduler, nothing is held between @ref scheduler_workers_start() and this call
  *.
  *
+ */
+static void scheduler_workers_stop(struct seq_file *m, void *v)
+{
+}
+
+/** @brief Shows the data/statistics of the @ref worker @p p, used by @ref scheduler_workers_seq_ops
+ *.
+ *  The worker threads are separated by an empty line
  *  
  *  @return returns @c UMS_SUCCESS if succesful 
  */
 static int worker_proc_show(struct seq_file *m, void *p)
 {
-    worker_t *worker = (worker_t*)m->private;
+    worker_t *worker = (worker_t*)p;
     seq_printf(m, "Worker id: %d\n", worker->wid);
     seq_printf(m, "Run by Scheduler#: %d\n", worker->sid);
     seq_printf(m, "Entry point: %p\n", (void*)worker->entry_point);
     seq_printf(m, "Completion list: %d\n", worker->clid);
+    seq_printf(m, "FPU state is switched: %s\n", (worker->flags & UMS_WORKER_NO_FPU) ? "no" : "yes");
+    seq_printf(m, "Size of the saved FPU state: %zu\n", (worker->flags & UMS_WORKER_NO_FPU) ? 0 : sizeof(worker->context.mxcsr) + sizeof(worker->context.fcw));
 	seq_printf(m, "Number of switches: %d\n", worker->switch_count);
     seq_printf(m, "Total running time of the thread: %lu\n", worker->total_exec_time);
+    seq_printf(m, "User CPU time of the thread: %llu\n", worker->user_time);
+    seq_printf(m, "System CPU time of the thread: %llu\n", worker->system_time);
+    seq_printf(m, "Time the thread was off CPU while running: %lu\n", worker->off_cpu_time);
+    seq_printf(m, "Total time the thread waited in the idle list: %llu\n", worker->total_wait_time);
+    seq_printf(m, "Time the thread waited in the idle list before the last execution: %llu\n", worker->last_wait_time);
+    seq_printf(m, "Maximum time the thread waited in the idle list: %llu\n", worker->max_wait_time);
+    seq_printf(m, "Number of time quantum expirations: %u\n", worker->quantum_expirations);
+    seq_printf(m, "Total time needed for switching CPU registers: %lu\n", worker->regs_switch_time);
+    seq_printf(m, "Total time needed for switching FPU control words: %lu\n", worker->fpu_switch_time);
     if(worker->state == IDLE) seq_printf(m, "Worker status is: IDLE.\n");
     else if(worker->state == RUNNING) seq_printf(m, "Worker status is: Running.\n");
 	else if(worker->state == FINISHED) seq_printf(m, "Worker status is: Finished.\n");
+    seq_putc(m, '\n');
+
+    return UMS_SUCCESS;
+}
+
+/** @brief Function that is used when opening info file inside the completion list folder, it will eventually calls @c single_open()
+ *.
+ *  The completion list is the data of the proc entry set by @ref create_completion_list_proc_entry(), thus no lookup is needed
+ *
+ *  @param inode
+ *  @param file
+ *  @return returns @c UMS_SUCCESS when succesful or error constant if there are any errors  
+ */
+static int completion_list_proc_open(struct inode *inode, struct file *file)
+{
+    return single_open(file, completion_list_proc_show, PDE_DATA(inode));
+}
+
+/** @brief Shows the data/statistics of the @ref completion_list_node and used by @c single_open()
+ *.
+ *  The counters are copied under completion_list_node::lock, after the rates are brought up to date by @ref update_completion_list_rates(),
+ *  so that the rates of a completion list without events decay as well
+ * 
+ *  @return returns @c UMS_SUCCESS if succesful 
+ */
+static int completion_list_proc_show(struct seq_file *m, void *p)
+{
+    completion_list_node_t *comp_list = (completion_list_node_t*)m->private;
+    unsigned int idle_count, busy_count, worker_count, finished_count, scheduler_count, peak_idle_count;
+    event_rate_t executes, pauses, finishes;
+    latency_histogram_t wait_time;
+    state_t state;
+
+    spin_lock(&comp_list->lock);
+    update_completion_list_rates(comp_list, ktime_get_ns());
+    state = comp_list->state;
+    idle_count = comp_list->idle_list->worker_count;
+    busy_count = comp_list->busy_list->worker_count;
+    worker_count = comp_list->worker_count;
+    finished_count = comp_list->finished_count;
+    scheduler_count = comp_list->scheduler_count;
+    peak_idle_count = comp_list->peak_idle_count;
+    executes = comp_list->executes;
+    pauses = comp_list->pauses;
+    finishes = comp_list->finishes;
+    wait_time = comp_list->wait_time;
+    spin_unlock(&comp_list->lock);
+
+    seq_printf(m, "Completion list id: %u\n", comp_list->clid);
+    seq_printf(m, "Number of worker threads: %u\n", worker_count);
+    seq_printf(m, "Number of idle worker threads: %u\n", idle_count);
+    seq_printf(m, "Number of running and finished worker threads: %u\n", busy_count);
+    seq_printf(m, "Number of finished worker threads: %u\n", finished_count);
+    seq_printf(m, "Peak number of idle worker threads: %u\n", peak_idle_count);
+    seq_printf(m, "Number of attached schedulers: %u\n", scheduler_count);
+    seq_printf(m, "Number of standby pthreads: %d\n", atomic_read(&comp_list->standby_count));
+    seq_printf(m, "Time quantum: %llu\n", READ_ONCE(comp_list->quantum));
+    seq_printf(m, "Number of executions: %lu\n", executes.count);
+    seq_printf(m, "Number of pauses: %lu\n", pauses.count);
+    seq_printf(m, "Number of finishes: %lu\n", finishes.count);
+    seq_printf(m, "Executions per second: %llu.%03llu\n", executes.rate / UMS_RATE_SCALE, executes.rate % UMS_RATE_SCALE);
+    seq_printf(m, "Pauses per second: %llu.%03llu\n", pauses.rate / UMS_RATE_SCALE, pauses.rate % UMS_RATE_SCALE);
+    seq_printf(m, "Finishes per second: %llu.%03llu\n", finishes.rate / UMS_RATE_SCALE, finishes.rate % UMS_RATE_SCALE);
+    seq_printf(m, "Average time worker threads waited in the idle list: %llu\n", wait_time.count != 0 ? div64_u64(wait_time.total, wait_time.count) : 0);
+    show_latency_histogram(m, "time worker threads waited in the idle list", &wait_time);
+    if(state == IDLE) seq_printf(m, "Completion list status is: IDLE.\n");
+    else if(state == RUNNING) seq_printf(m, "Completion list status is: Running.\n");
+    else if(state == FINISHED) seq_printf(m, "Completion list status is: Finished.\n");
+
+    return UMS_SUCCESS;
+}
+
+/** @brief Starts or resumes the iteration over the worker threads of the workers file of the process
+ *.
+ *  The process is the data of the proc entry set by @ref create_process_proc_entry().
+ *  Position 0 is the header line, position @c n is the worker thread with ID @c n - 1 or the next one after it.
+ *
+ *  @return returns @c SEQ_START_TOKEN, pointer to @ref worker or @c NULL if there are no more worker threads
+ */
+static void *process_workers_start(struct seq_file *m, loff_t *pos)
+{
+    worker_t *worker;
+    loff_t wid;
+
+    if(*pos == 0)
+    {
+        return SEQ_START_TOKEN;
+    }
+
+    wid = *pos - 1;
+    worker = find_process_worker(PDE_DATA(file_inode(m->file)), &wid);
+    if(worker != NULL)
+    {
+        *pos = wid + 1;
+    }
+    return worker;
+}
+
+/** @brief Advances the iteration over the worker threads of the workers file of the process to the worker thread after @p v
+ *.
+ *
+ *  @return returns pointer to @ref worker or @c NULL if there are no more worker threads
+ */
+static void *process_workers_next(struct seq_file *m, void *v, loff_t *pos)
+{
+    (*pos)++;
+    return process_workers_start(m, pos);
+}
+
+/** @brief Ends the iteration over the worker threads of the workers file of the process, nothing is held between @ref process_workers_start() and this call
+ *.
+ *
+ */
+static void process_workers_stop(struct seq_file *m, void *v)
+{
+}
+
+/** @brief Shows a line of the workers file of the process
+ *.
+ *  Every worker thread is shown on a line of fixed format, so that the file can be parsed without lookups by name:
+ *  ID, scheduler that ran it last time (-1 if it was not run yet), completion list, state, number of switches, execution time and time spent in the idle list in nanoseconds
+ *
+ *  @return returns @c UMS_SUCCESS if succesful 
+ */
+static int process_workers_show(struct seq_file *m, void *v)
+{
+    worker_t *worker = (worker_t*)v;
+    state_t state;
+
+    if(v == SEQ_START_TOKEN)
+    {
+        seq_puts(m, "wid sid clid state switches exec_time wait_time\n");
+        return UMS_SUCCESS;
+    }
+
+    state = READ_ONCE(worker->state);
+    seq_printf(m, "%u %d %u %s %u %lu %llu\n", worker->wid, (int)worker->sid, worker->clid,
+        state == IDLE ? "IDLE" : state == RUNNING ? "RUNNING" : "FINISHED",
+        worker->switch_count, worker->total_exec_time, worker->total_wait_time);
 
     return UMS_SUCCESS;
 }
@@ -30,16 +30,41 @@
 #include "const.h"
 
 #include <asm/current.h>
+#include <asm/irq_regs.h>
 #include <asm/fpu/internal.h>
 #include <asm/fpu/types.h>
+#include <asm/fpu/xstate.h>
 #include <linux/kernel.h>
 #include <linux/module.h>
 #include <linux/list.h>
+#include <linux/hashtable.h>
+#include <linux/rculist.h>
 #include <linux/slab.h>	
+#include <linux/spinlock.h>
+#include <linux/xarray.h>
+#include <linux/kref.h>
+#include <linux/wait.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
+#include <linux/vmalloc.h>
+#include <linux/mm.h>
+#include <linux/preempt.h>
+#include <linux/irq_work.h>
+#include <linux/hrtimer.h>
+#include <linux/sched/signal.h>
 #include <linux/types.h>
 #include <linux/time.h>
 #include <linux/proc_fs.h>
 #include <linux/seq_file.h>
+#include <linux/profile.h>
+#include <linux/notifier.h>
+
+#if !IS_ENABLED(CONFIG_PREEMPT_NOTIFIERS)
+#error "UMS kernel module requires CONFIG_PREEMPT_NOTIFIERS (selected by CONFIG_KVM) to detect worker threads blocking in the kernel"
+#endif
+#if !IS_ENABLED(CONFIG_PROFILING)
+#error "UMS kernel module requires CONFIG_PROFILING for the PROFILE_TASK_EXIT notifier that stops the hosts of exiting pthreads"
+#endif
 
 typedef struct process_list process_list_t;
 typedef struct process process_t;
@@ -52,47 +77,70 @@ typedef struct scheduler scheduler_t;
 
 typedef struct process_proc_entry  process_proc_entry_t;
 typedef struct scheduler_proc_entry scheduler_proc_entry_t;
-typedef struct worker_proc_entry worker_proc_entry_t;
-
-int enter_ums(void);
-int exit_ums(void);
-ums_clid_t create_completion_list(void);
-ums_wid_t create_worker_thread(worker_params_t *params);
-ums_sid_t enter_scheduling_mode(scheduler_params_t *params);
-int exit_scheduling_mode(void);
-int execute_thread(ums_wid_t worker_id);
-int thread_yield(worker_status_t status);
-int dequeue_completion_list_items(list_params_t *params);
+typedef struct completion_list_proc_entry completion_list_proc_entry_t;
+typedef struct file_context file_context_t;
+typedef struct host host_t;
+
+int enter_ums(file_context_t *context);
+int exit_ums(file_context_t *context);
+void unbind_process(file_context_t *context, bool host_in_use);
+ums_clid_t create_completion_list(file_context_t *context);
+ums_wid_t create_worker_thread(file_context_t *context, worker_params_t *params);
+ums_sid_t enter_scheduling_mode(file_context_t *context, scheduler_params_t *params);
+int exit_scheduling_mode(file_context_t *context);
+int execute_thread(file_context_t *context, ums_wid_t worker_id);
+int thread_yield(file_context_t *context, worker_status_t status);
+int switch_to_thread(file_context_t *context, ums_wid_t worker_id);
+int thread_yield_to(file_context_t *context, switch_params_t *params);
+int preempt_thread(file_context_t *context);
+int mmap_ready_ring(file_context_t *context, struct vm_area_struct *vma);
+int mmap_stats_page(file_context_t *context, struct vm_area_struct *vma);
+int enter_standby(file_context_t *context, ums_clid_t clid);
+int set_completion_list_quantum(file_context_t *context, quantum_params_t *params);
+int get_stats(file_context_t *context, stats_params_t *params);
+int delete_host(host_t *host);
+int register_host_exit(void);
+void unregister_host_exit(void);
+int dequeue_completion_list_items(file_context_t *context, list_params_t *params);
+int dequeue_completion_list_items_wait(file_context_t *context, list_params_t *params);
 int delete_process(process_t *process);
+void put_process(process_t *process);
 int delete_completion_lists_and_worker_threads(process_t *process);
 int delete_workers_from_completion_list(worker_list_t *worker_list);
 int delete_workers_from_process_list(worker_list_t *worker_list);
 int delete_schedulers(process_t *process);
 process_t *create_process_node(pid_t pid);
 process_t *check_if_process_exists(pid_t pid);
+process_t *get_process(pid_t pid);
 completion_list_node_t *check_if_completion_list_exists(process_t *proc, ums_clid_t clid);
 scheduler_t *check_if_scheduler_exists(process_t *proc, ums_sid_t sid);
 scheduler_t *check_if_scheduler_exists_run_by(process_t *process, pid_t pid);
-worker_t *check_if_worker_exists(worker_list_t *worker_list, ums_wid_t wid);
-worker_t *check_if_worker_exists_global(worker_list_t *worker_list, ums_wid_t wid);
+worker_t *check_if_worker_exists(process_t *process, ums_wid_t wid);
 state_t check_if_schedulers_state(process_t *proc);
-unsigned long get_exec_time(struct timespec64 *prev_time);
+unsigned long get_exec_time(u64 prev_time);
+void record_switch_latency(file_context_t *context, u64 latency);
 int cleanup(void);
+int init_caches(void);
+void delete_caches(void);
 
 int init_proc(void);
 int delete_proc(void);
 int create_process_proc_entry(process_t *process);
 int create_scheduler_proc_entry(process_t *process, scheduler_t *scheduler);
-int create_worker_proc_entry(process_t *process, scheduler_t *scheduler, worker_t *worker);
+int create_completion_list_proc_entry(process_t *process, completion_list_node_t *comp_list);
 int delete_process_proc_entry(process_t *process);
+int delete_scheduler_proc_entry(scheduler_t *scheduler);
 
-/** @brief The list of the processes handled by the UMS kernel module
+/** @brief The table of the processes handled by the UMS kernel module
  *.
+ *  Processes are hashed by their pid (tgid of the process threads), lookups are performed under RCU without taking any lock
  *
  */
 typedef struct process_list {
-    struct list_head list;          
-    unsigned int process_count;     /**< Number of processes handled by the UMS kernel module*/
+    DECLARE_HASHTABLE(table, UMS_PROCESS_HASH_BITS);    /**< Hashtable of processes keyed by pid */
+    spinlock_t lock;                                    /**< Serializes insertions and removals of processes; it is never held together with other locks of the UMS kernel module */
+    unsigned int process_count;                         /**< Number of processes handled by the UMS kernel module*/
+    struct list_head released;                          /**< Processes that were removed from process_list::table, but are still referenced by the opened files */
 } process_list_t;
 
 /** @brief Represents a node in the @ref process_list 
@@ -101,12 +149,18 @@ typedef struct process_list {
  */
 typedef struct process {
     pid_t pid;                              /**< pid of the process or tgid of the process threads */
-    struct list_head list;                  
+    struct hlist_node node;                 /**< Node in the process_list::table bucket */
+    struct rcu_head rcu;                    /**< Used to free the process after RCU grace period */
+    struct kref refcount;                   /**< One reference is held while the process is in process_list::table and one by each @ref file_context bound to it */
+    struct list_head list;                  /**< Node in process_list::released once the process is removed from process_list::table */
+    spinlock_t lock;                        /**< Protects the lists of completion lists, worker threads and schedulers of the process and their counters */
     state_t state;                          /**< State of the process */
     completion_list_t *completion_lists;    /**< List of completions lists created by the process */
     worker_list_t *worker_list;             /**< List of worker threads created by the process  */
+    struct xarray workers;                  /**< Worker threads created by the process indexed by their IDs, it also allocates worker thread IDs */
     scheduler_list_t *scheduler_list;       /**< List of schedulers created by the process  */
     process_proc_entry_t *proc_entry;       /**< Proc entries of the process */
+    stats_page_t *stats_page;               /**< Counters of the schedulers shared read-only with the user space, mapped via @ref mmap_stats_page() */
 } process_t;
 
 /** @brief The list of the completion lists created by the specific process
@@ -118,6 +172,30 @@ typedef struct completion_list {
     unsigned int list_count;        /**< Number of completion lists created by the process */
 } completion_list_t;
 
+/** @brief Distribution of latencies in nanoseconds
+ *.
+ *  Bucket @c i counts latencies in [2^i, 2^(i+1)) nanoseconds, the last bucket counts the longer ones as well.
+ *  Updated by @ref record_latency(), the percentiles are estimated by @ref get_latency_percentile().
+ */
+typedef struct latency_histogram {
+    unsigned long count;                            /**< Number of recorded latencies */
+    u64 total;                                      /**< Sum of recorded latencies */
+    u64 min;                                        /**< Minimum latency, @c U64_MAX if none was recorded */
+    u64 max;                                        /**< Maximum latency */
+    unsigned long buckets[UMS_LATENCY_BUCKETS];     /**< Number of latencies by log2 bucket */
+} latency_histogram_t;
+
+/** @brief Rate of the events of the completion list
+ *.
+ *  The rate is an exponentially weighted moving average of the events per second, sampled every @ref UMS_RATE_INTERVAL nanoseconds
+ *  with the weight of 1 / 2^@ref UMS_RATE_WEIGHT_SHIFT. Updated by @ref update_event_rate().
+ */
+typedef struct event_rate {
+    unsigned long count;            /**< Total number of events */
+    unsigned long sampled_count;    /**< Value of event_rate::count when the rate was sampled last time */
+    u64 rate;                       /**< Moving average of the events per second, multiplied by @ref UMS_RATE_SCALE */
+} event_rate_t;
+
 /** @brief Represents a node in the @ref completion_list
  *.
  *
@@ -125,11 +203,28 @@ typedef struct completion_list {
 typedef struct completion_list_node {
     ums_clid_t clid;                /**< Completion list ID */
     struct list_head list;          
+    spinlock_t lock;                /**< Protects idle and busy lists, the counters and the state of the completion list; nested inside process::lock */
     unsigned int worker_count;      /**< Number of worker threads assigned to the completion list */
     unsigned int finished_count;    /**< Number of worker threads that has completed their work */
     state_t state;                  /**< State of the completion list */
-    worker_list_t *idle_list;       /**< List of worker threads that are ready and waiting to be scheduled */
+    worker_list_t *idle_list;       /**< List of worker threads that are ready and waiting to be scheduled, it keeps the order in which they are dequeued (lookups by ID use process::workers) */
     worker_list_t *busy_list;       /**< List of worker threads that has been completed or currently running */
+    struct xarray workers;          /**< Worker threads assigned to the completion list indexed by their IDs, updated under completion_list_node::lock when a worker thread is created or stolen */
+    wait_queue_head_t wait_queue;   /**< Schedulers sleeping in @ref dequeue_completion_list_items_wait() until there are idle worker threads or all of them have finished */
+    ready_ring_t *ready_ring;       /**< Ring of worker threads that became idle, mapped by the schedulers; written under completion_list_node::lock */
+    spinlock_t standby_lock;        /**< Protects completion_list_node::handoff_list, taken with interrupts disabled */
+    struct list_head handoff_list;  /**< Schedulers whose worker threads have blocked in the kernel, waiting for a standby pthread */
+    wait_queue_head_t standby_wait; /**< Standby pthreads of the completion list */
+    atomic_t standby_count;         /**< Number of standby pthreads waiting on completion_list_node::standby_wait */
+    u64 quantum;                    /**< Time in nanoseconds a worker thread runs before it is preempted, 0 if preemption is disabled */
+    latency_histogram_t wait_time;  /**< Time worker threads spent in the idle list before they were executed; updated under completion_list_node::lock */
+    unsigned int scheduler_count;   /**< Number of schedulers attached to the completion list, that have not exited scheduling mode */
+    unsigned int peak_idle_count;   /**< Maximum number of worker threads that were in the idle list at once */
+    event_rate_t executes;          /**< Worker threads claimed for execution by the schedulers */
+    event_rate_t pauses;            /**< Worker threads returned to the idle list */
+    event_rate_t finishes;          /**< Worker threads that have completed their work */
+    u64 rate_time;                  /**< Monotonic time in nanoseconds when the rates were sampled last time */
+    completion_list_proc_entry_t *proc_entry;   /**< Proc entry of the completion list */
 } completion_list_node_t;
 
 /** @brief The list of the worker threads
@@ -141,6 +236,31 @@ typedef struct worker_list {
     unsigned int worker_count;      /**< Number of worker threads created by the process */
 } worker_list_t;
 
+/** @brief Compact context of a worker thread, a scheduler or a pthread hosting schedulers, suspended at a function call boundary
+ *.
+ *  Worker threads and schedulers pause and switch through calls of the UMS library, and a pthread stops hosting schedulers in one, thus only the registers
+ *  the calling convention preserves across a call (callee-saved registers, stack and instruction pointers, flags, SSE and x87 control words) have to be saved to resume them.
+ *  compact_context::di passes the function arguments to the entry point on the first run.
+ *
+ *  The extended state (SSE, AVX, AVX-512 registers etc.) is deliberately not kept per worker thread. The System V x86-64 ABI makes all vector and x87 data registers
+ *  caller-saved, while the MXCSR control bits and the x87 control word are callee-saved, so a thread suspended at a call of the UMS library expects only the latter to survive.
+ *  A worker thread preempted by the time quantum is suspended inside the handler of @c UMS_PREEMPT_SIGNAL, whose signal frame is where the kernel saves and restores its' full extended state.
+ */
+typedef struct compact_context {
+    unsigned long ip;                                   /**< Instruction pointer */
+    unsigned long sp;                                   /**< Stack pointer */
+    unsigned long bp;                                   /**< Frame pointer */
+    unsigned long bx;
+    unsigned long r12;
+    unsigned long r13;
+    unsigned long r14;
+    unsigned long r15;
+    unsigned long di;                                   /**< First argument of the entry point */
+    unsigned long flags;
+    u32 mxcsr;                                          /**< SSE control and status register */
+    u16 fcw;                                            /**< x87 control word */
+} compact_context_t;
+
 /** @brief Represents a node in the @ref worker_list
  *.
  *
@@ -151,17 +271,29 @@ typedef struct worker {
     pid_t tid;                                          /**< pid of the process that created the worker thread */
     ums_sid_t sid;                                      /**< ID of the scheduler which manages the current worker thread */
     ums_clid_t clid;                                    /**< ID of the completion list where worker thread is assigned to */
+    unsigned int flags;                                 /**< Flags passed on creation of the worker thread, e.g. @ref UMS_WORKER_NO_FPU */
     unsigned long entry_point;                          /**< Function pointer and an entry point set by a user, that serves as a starting point of the worker thread  * */
     unsigned long stack_addr;                           /**< Address of the stack allocated by the UMS library */
-    struct pt_regs regs;                                /**< Snapshot of CPU registers */
-    struct fpu fpu_regs;                                /**< Snapshot of FPU registers */
+    compact_context_t context;                          /**< Registers of the worker thread suspended by a call of the UMS library */
     struct list_head global_list;                       /**< List of the worker threads created by the process */
     struct list_head local_list;                        /**< List of the worker threads of the completion list */
     state_t state;                                      /**< State of worker thread's progress */
-    worker_proc_entry_t *proc_entry;                    /**< Proc entry of the worker thread */
     unsigned int switch_count;                          /**< Number of context switches */
-    unsigned long total_exec_time;                      /**< Total execution time of the worker thread */
-    struct timespec64 time_of_the_last_switch;          /**< Time when the last switch occured */
+    unsigned long total_exec_time;                      /**< Total execution time of the worker thread in nanoseconds, the time the pthread running it was off CPU is not included */
+    unsigned long off_cpu_time;                         /**< Total time in nanoseconds the pthread running the worker thread was off CPU (preempted by the kernel or blocked) */
+    u64 user_time;                                      /**< Total user CPU time in nanoseconds, accounted from @c utime of the pthread running the worker thread */
+    u64 system_time;                                    /**< Total system CPU time in nanoseconds, accounted from @c stime of the pthread running the worker thread */
+    unsigned long off_cpu_at_switch;                    /**< Value of worker::off_cpu_time when the worker thread was run last time */
+    u64 utime_at_switch;                                /**< @c utime of the pthread when the worker thread was run last time */
+    u64 stime_at_switch;                                /**< @c stime of the pthread when the worker thread was run last time */
+    u64 time_of_the_last_switch;                        /**< Monotonic time in nanoseconds when the last switch occured */
+    u64 idle_since;                                     /**< Monotonic time in nanoseconds when the worker thread entered the idle list last time; kept when it is stolen */
+    u64 total_wait_time;                                /**< Total time in nanoseconds the worker thread spent in the idle list before it was executed */
+    u64 last_wait_time;                                 /**< Time in nanoseconds the worker thread spent in the idle list before it was executed last time */
+    u64 max_wait_time;                                  /**< Maximum time in nanoseconds the worker thread spent in the idle list before it was executed */
+    unsigned int quantum_expirations;                   /**< Number of times the worker thread was preempted, since its' time quantum expired */
+    unsigned long regs_switch_time;                     /**< Total time in nanoseconds spent saving and loading CPU registers of the worker thread */
+    unsigned long fpu_switch_time;                      /**< Total time in nanoseconds spent saving and loading FPU control words of the worker thread */
 } worker_t;
 
 /** @brief The list of the schedulers created by the specific process
@@ -182,13 +314,11 @@ typedef struct scheduler {
     pid_t pid;                                                  /**< pid of the process thread that is currently running the scheduler */
     pid_t tid;                                                  /**< pid of the process that created the scheduler */
     ums_wid_t wid;                                              /**< ID of the worker that is managed by the scheduler */
+    worker_t *worker;                                           /**< Pointer of the worker that is currently run by the scheduler; owned by the scheduler's pthread, thus accessed without locking */
+    process_t *process;                                         /**< Pointer of the process that created the scheduler */
 	unsigned long entry_point;                                  /**< Function pointer and an entry point set by a user, that serves as a starting point of the scheduler. It is a scheduling function that determines the next thread to be scheduled */
-    unsigned long return_addr;                                  /**< Snapshot of the instruction pointer that is restored when exiting scheduling mode */
-    unsigned long stack_ptr;                                    /**< Snapshot of the stack pointer that is restored when exiting scheduling mode */
-    unsigned long base_ptr;                                     /**< Snapshot of the base pointer that is restored when exiting scheduling mode */
     state_t state;                                              /**< State of the scheduler */
-    struct pt_regs regs;                                        /**< Snapshot of CPU registers */
-    struct fpu fpu_regs;                                        /**< Snapshot of FPU registers */
+    compact_context_t context;                                  /**< Registers of the scheduler suspended by a switch call of the UMS library, set to its' entry point before the first run */
     completion_list_node_t *comp_list;                          /**< Pointer of the completion list that is associated with the scheduler */
     struct list_head list;                                      
     scheduler_proc_entry_t *proc_entry;                         /**< Proc entry of the scheduler */
@@ -196,9 +326,73 @@ typedef struct scheduler {
     unsigned long avg_switch_time;                              /**< Average time needed for context switch */
     unsigned long time_needed_for_the_last_switch;              /**< Time needed for the last context switch */
     unsigned long total_time_needed_for_the_switch;             /**< Total time needed for the context switches*/
-    struct timespec64 time_of_the_last_switch;                  /**< Time when the last switch occured */
+    u64 time_of_the_last_switch;                                /**< Monotonic time in nanoseconds when the last switch occured */
+    latency_histogram_t switch_latency;                         /**< Latencies of the context switches recorded by @ref record_switch_latency() */
+    u64 spin_limit;                                             /**< Maximum time in nanoseconds the scheduler spins before sleeping in a blocking dequeue, set by scheduler_params::spin_threshold */
+    u64 spin_threshold;                                         /**< Current time in nanoseconds the scheduler spins before sleeping in a blocking dequeue, adapted to how soon worker threads become available */
+    struct irq_work irq_work;                                   /**< Hands off the scheduler to a standby pthread when its' worker thread blocks in the kernel */
+    struct list_head handoff_list;                              /**< Links the scheduler to completion_list_node::handoff_list */
+    host_t *host;                                               /**< Pthread that currently runs the scheduler */
+    struct hrtimer quantum_timer;                               /**< Armed when the scheduler switches to a worker thread, if the completion list has a time quantum */
+    int quantum_cpu;                                            /**< CPU scheduler::quantum_timer is pinned to, it is moved to the CPU of the pthread by @ref host_sched_in() when the pthread migrates */
+    unsigned long preempt_pending;                              /**< Bit 0 is set while @c UMS_PREEMPT_SIGNAL sent when the time quantum expired is pending, until it is handled by @ref preempt_thread() */
+    unsigned int preempt_switch;                                /**< Value of scheduler::switch_count when the time quantum expired, a stale preemption is detected by it */
+    unsigned int steal_batch;                                   /**< Maximum number of worker threads taken from another completion list at once, 0 if work stealing is disabled */
+    unsigned long steal_attempts;                               /**< Number of times the scheduler tried to steal worker threads */
+    unsigned long steal_successes;                              /**< Number of times the scheduler has stolen worker threads */
+    unsigned long stolen_workers;                               /**< Number of worker threads migrated to the completion list of the scheduler */
+    bool fpu_saved;                                             /**< Set while a worker thread that uses FPU is run, i.e. FPU registers do not hold the control words of the scheduler saved to scheduler::context anymore */
+    struct fpu *fpu_check;                                      /**< Snapshots of FPU state compared when a worker thread created with @ref UMS_WORKER_NO_FPU is suspended, allocated in the debug mode only */
+    bool fpu_check_armed;                                       /**< Set while scheduler::fpu_check holds a snapshot taken when a worker thread created with @ref UMS_WORKER_NO_FPU was run */
+    scheduler_live_stats_t *live_stats;                         /**< Entry of process::stats_page the counters are published to by @ref publish_scheduler_stats(), NULL if the scheduler ID is too high */
 } scheduler_t;
 
+/** @brief Pthread that runs schedulers: the pthread that created a scheduler or a standby pthread of the completion list
+ *.
+ *  While the pthread runs a scheduler, its' preempt notifier detects the worker thread blocking in the kernel. Then the scheduler is handed off to a standby pthread,
+ *  while the blocked pthread continues the worker thread once the system call completes, and returns it to the completion list and becomes a standby pthread itself
+ *  as soon as the worker thread is back in the user space (see @ref park_expired()) or issues a switch call.
+ *  Owned by the pthread and stored in @ref file_context of the UMS device opened by it. If the file is released by another pthread while the host still runs a scheduler,
+ *  the host is freed by @ref host_task_exit() when the pthread exits instead.
+ */
+typedef struct host {
+    struct task_struct *task;                                   /**< Task of the pthread, the host holds a reference of it */
+    process_t *process;                                         /**< Process the pthread belongs to, the reference of the file is handed over to the host if it outlives the file */
+    struct hlist_node node;                                     /**< Node in the host_list::table bucket */
+    bool released;                                              /**< Set if the file was released while the host was in use, then it is freed when the pthread exits */
+    scheduler_t *scheduler;                                     /**< Scheduler run by the pthread, NULL while the pthread is standby */
+    worker_t *blocked_worker;                                   /**< Worker thread that has blocked in the kernel while run by the pthread, it is run by the pthread until it is parked */
+    bool in_ioctl;                                              /**< Set while the pthread is in an ioctl call of UMS device, since sleeping there is not blocking of the worker thread */
+    struct preempt_notifier notifier;                           /**< Registered while the pthread runs a scheduler */
+    struct hrtimer park_timer;                                  /**< Armed when the pthread is scheduled in while host::blocked_worker is set, to park it once the worker thread returns to the user space */
+    unsigned long park_pending;                                 /**< Bit 0 is set while @c UMS_PREEMPT_SIGNAL sent by host::park_timer is not handled by @ref preempt_thread() */
+    worker_t *off_cpu_worker;                                   /**< Worker thread run by the pthread while it is switched out by the kernel scheduler, NULL if there is none */
+    u64 sched_out_time;                                         /**< Monotonic time in nanoseconds the pthread was switched out while running host::off_cpu_worker */
+    compact_context_t home;                                     /**< Registers the pthread returns to when it stops running a scheduler, saved on @c UMS_ENTER_SCHEDULING_MODE or @c UMS_ENTER_STANDBY */
+} host_t;
+
+/** @brief The table of the @ref host data structures, keyed by pid of their pthreads
+ *.
+ *  Lets @ref host_task_exit() find the host of the exiting pthread without walking its' preempt notifiers
+ *
+ */
+typedef struct host_list {
+    DECLARE_HASHTABLE(table, UMS_HOST_HASH_BITS);       /**< Hashtable of hosts keyed by pid of the pthread */
+    spinlock_t lock;                                    /**< Protects host_list::table, host::scheduler cleared by another pthread and host::released; it is never held together with other locks of the UMS kernel module */
+} host_list_t;
+
+/** @brief Context of the opened UMS device, which is stored in @c private_data of the file
+ *.
+ *  The UMS library opens the device once per scheduler pthread, therefore after @ref enter_scheduling_mode() the context caches the scheduler run by that pthread
+ *
+ */
+typedef struct file_context {
+    process_t *process;             /**< Pointer of the process that was bound to the file on the first call, the file holds a reference of it until it is released */
+    bool owner;                     /**< Set if the process was registered through the file by @ref enter_ums(), then releasing the file finishes the process */
+    scheduler_t *scheduler;         /**< Pointer of the scheduler that was bound to the file by @ref enter_scheduling_mode() */
+    host_t *host;                   /**< Pthread that opened the file, allocated by @ref enter_scheduling_mode() or @ref enter_standby() */
+} file_context_t;
+
 /** @brief Responsible for tracking proc_dir_entries of the process
  *.
  *
@@ -207,6 +401,8 @@ typedef struct process_proc_entry {
 	struct proc_dir_entry *pde;         /**< proc_dir_entry of the process (/proc/ums/<PID>/) */
 	struct proc_dir_entry *parent;      /**< Parent folder of the process' folder (/proc/ums/) */
 	struct proc_dir_entry *child;       /**< Child folder of the process' folder (/proc/ums/<PID>/schedulers/) */
+	struct proc_dir_entry *comp_lists;  /**< Child folder of the process' folder (/proc/ums/<PID>/completion_lists/) */
+	struct proc_dir_entry *workers;     /**< File that contains a line of statistics per worker thread of the process, generated when it is read (/proc/ums/<PID>/workers) */
 } process_proc_entry_t;
 
 /** @brief Responsible for tracking proc_dir_entries of the schedulers of the specific process
@@ -216,15 +412,16 @@ typedef struct process_proc_entry {
 typedef struct scheduler_proc_entry {
 	struct proc_dir_entry *pde;     /**< proc_dir_entry of the scheduler of the specific process (/proc/ums/<PID>/schedulers/<Scheduler ID>/) */                             
 	struct proc_dir_entry *parent;  /**< Parent folder of the scheduler's folder (/proc/ums/<PID>/schedulers/) */
-	struct proc_dir_entry *child;   /**< Child folder of the scheduler's folder (/proc/ums/<PID>/schedulers/<Scheduler ID>/workers/) */
+	struct proc_dir_entry *workers; /**< File that contains information and statistics of the worker threads of the completion list assigned to the scheduler, generated when it is read (/proc/ums/<PID>/schedulers/<Scheduler ID>/workers) */
 	struct proc_dir_entry *info;    /**< File that contains information and statistics of the scheduler performance (/proc/ums/<PID>/schedulers/<Scheduler ID>/info) */
 } scheduler_proc_entry_t;
 
-/** @brief Responsible for tracking proc_dir_entries of the worker of the specific process
+/** @brief Responsible for tracking proc_dir_entries of the completion list of the specific process
  *.
  *
  */
-typedef struct worker_proc_entry {
-	struct proc_dir_entry *pde;     /**< proc_dir_entry of the worker thread of the completion list that is assigned to a specific scheduler and contains information/statistics regarding worker thread's performance (/proc/ums/<PID>/schedulers/<Scheduler ID>/workers/<Worker ID>) */
-	struct proc_dir_entry *parent;  /**< Parent folder of the worker thread's file (/proc/ums/<PID>/schedulers/<Scheduler ID>/workers/) */
-} worker_proc_entry_t;
\ No newline at end of file
+typedef struct completion_list_proc_entry {
+	struct proc_dir_entry *pde;     /**< proc_dir_entry of the completion list of the specific process (/proc/ums/<PID>/completion_lists/<Completion list ID>/) */
+	struct proc_dir_entry *parent;  /**< Parent folder of the completion list's folder (/proc/ums/<PID>/completion_lists/) */
+	struct proc_dir_entry *info;    /**< File that contains information and statistics of the completion list (/proc/ums/<PID>/completion_lists/<Completion list ID>/info) */
+} completion_list_proc_entry_t;
\ No newline at end of file
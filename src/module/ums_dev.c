@@ -27,28 +27,30 @@
  */
 #include "ums_dev.h"
 
+#define CREATE_TRACE_POINTS
+#include "ums_trace.h"
+
 #include <linux/kernel.h>
 #include <linux/module.h>
 #include <linux/miscdevice.h>
-#include <linux/spinlock.h>
 #include <linux/fs.h>
 
 MODULE_AUTHOR("Bektur Umarbaev");
 MODULE_DESCRIPTION("User Mode thread Scheduling (UMS)");
 MODULE_LICENSE("GPL");
 
-/*
- * Global variables
- */
-DEFINE_SPINLOCK(spinlock_ums);
-unsigned long spinlock_flags_ums;
-
+static int open_ums(struct inode *inode, struct file *file);
+static int release_ums(struct inode *inode, struct file *file);
 static long ioctl_ums(struct file *file, unsigned int cmd, unsigned long arg);
+static int mmap_ums(struct file *file, struct vm_area_struct *vma);
 
 static const struct file_operations fops_ums = {
 	.owner		    = THIS_MODULE,
+    .open           = open_ums,
+    .release        = release_ums,
 	.unlocked_ioctl	= ioctl_ums,
-    .compat_ioctl   = ioctl_ums
+    .compat_ioctl   = ioctl_ums,
+    .mmap           = mmap_ums
 };
 
 static struct miscdevice dev_ums = {
@@ -58,8 +60,56 @@ static struct miscdevice dev_ums = {
 	.fops		= &fops_ums,
 };
 
+/** @brief The function that is called when UMS device is opened
+ *.
+ *  Allocates @ref file_context and stores it in @c private_data of the file
+ *
+ *  @param inode
+ *  @param file
+ *  @return returns @c UMS_SUCCESS when succesful or @c -ENOMEM if the context cannot be allocated
+ */
+static int open_ums(struct inode *inode, struct file *file)
+{
+    file_context_t *context;
+
+    context = kzalloc(sizeof(file_context_t), GFP_KERNEL);
+    if(context == NULL)
+    {
+        return -ENOMEM;
+    }
+
+    file->private_data = context;
+    return UMS_SUCCESS;
+}
+
+/** @brief The function that is called when the last reference to the opened UMS device is closed
+ *.
+ *  Deletes the @ref host of the pthread that opened the file via @ref delete_host(), drops the reference of the process bound to the file via @ref unbind_process() and frees @ref file_context of the file.
+ *  The files are closed when the process exits as well, thus the process is deleted even if it has not called @ref exit_ums().
+ *
+ *  @param inode
+ *  @param file
+ *  @return returns @c UMS_SUCCESS
+ */
+static int release_ums(struct inode *inode, struct file *file)
+{
+    file_context_t *context = file->private_data;
+    int ret;
+
+    ret = delete_host(context->host);
+    unbind_process(context, ret != UMS_SUCCESS);
+    kfree(context);
+    return UMS_SUCCESS;
+}
+
 /** @brief The function that is responsible for ioctl calls
  *.
+ *  No global lock is taken here: each command synchronizes on the process and completion list it works with (process::lock, completion_list_node::lock),
+ *  while a scheduler switching to and from its own worker thread touches only data owned by its' pthread.
+ *  Scheduler commands reach the scheduler through @ref file_context stored in @c private_data of the @p file.
+ *  The call is traced by @c ums_ioctl_enter and @c ums_ioctl_exit tracepoints instead of being logged, since it is issued on every context switch.
+ *  While the pthread is in the call, host::in_ioctl is set, so that sleeping in the call is not treated as blocking of the worker thread.
+ *  The latency of the successful switch commands is measured with the monotonic clock from the entry to the return of the call and recorded by @ref record_switch_latency().
  *
  *  @param file
  *  @param cmd command number
@@ -68,52 +118,109 @@ static struct miscdevice dev_ums = {
  */
 static long ioctl_ums(struct file *file, unsigned int cmd, unsigned long arg)
 {
-    int ret = 0;
+    file_context_t *context = file->private_data;
+    host_t *host = READ_ONCE(context->host);
+    u64 start = ktime_get_ns();
+    bool is_switch = false;
+    long ret = 0;
 
-    spin_lock_irqsave(&spinlock_ums, spinlock_flags_ums);
-
-    printk(KERN_INFO UMS_MODULE_NAME_LOG "> IOCTL_START: pid: %d, tgid: %d, IOCTL:%d\n", current->pid, current->tgid, cmd);
+    trace_ums_ioctl_enter(cmd);
+    if(host != NULL && host->task == current)
+    {
+        host->in_ioctl = true;
+    }
     
     switch (cmd) {
         case UMS_ENTER:
-            ret = enter_ums();
+            ret = enter_ums(context);
             goto out;
         case UMS_EXIT:
-            ret = exit_ums();
+            ret = exit_ums(context);
             goto out;
         case UMS_CREATE_LIST:
-            ret = create_completion_list();
+            ret = create_completion_list(context);
             goto out;
         case UMS_CREATE_WORKER:
-            ret = create_worker_thread((worker_params_t*)arg);
+            ret = create_worker_thread(context, (worker_params_t*)arg);
             goto out;
         case UMS_ENTER_SCHEDULING_MODE:
-            ret = enter_scheduling_mode((scheduler_params_t*)arg);
+            ret = enter_scheduling_mode(context, (scheduler_params_t*)arg);
             goto out;
         case UMS_EXIT_SCHEDULING_MODE:
-            ret = exit_scheduling_mode();
+            ret = exit_scheduling_mode(context);
             goto out;
         case UMS_EXECUTE_THREAD:
-			ret = execute_thread((ums_wid_t)arg);
+			ret = execute_thread(context, (ums_wid_t)arg);
+            is_switch = true;
             goto out;
         case UMS_THREAD_YIELD:
-            ret = thread_yield((worker_status_t)arg);
+            ret = thread_yield(context, (worker_status_t)arg);
+            is_switch = true;
+            goto out;
+        case UMS_SWITCH_TO:
+            ret = switch_to_thread(context, (ums_wid_t)arg);
+            is_switch = true;
+            goto out;
+        case UMS_THREAD_YIELD_TO:
+            ret = thread_yield_to(context, (switch_params_t*)arg);
+            is_switch = true;
+            goto out;
+        case UMS_THREAD_PREEMPT:
+            ret = preempt_thread(context);
+            is_switch = true;
             goto out;
         case UMS_DEQUEUE_COMPLETION_LIST_ITEMS:
-            ret = dequeue_completion_list_items((list_params_t*)arg);
+            ret = dequeue_completion_list_items(context, (list_params_t*)arg);
+            goto out;
+        case UMS_DEQUEUE_COMPLETION_LIST_ITEMS_WAIT:
+            ret = dequeue_completion_list_items_wait(context, (list_params_t*)arg);
+            goto out;
+        case UMS_ENTER_STANDBY:
+            ret = enter_standby(context, (ums_clid_t)arg);
+            goto out;
+        case UMS_SET_QUANTUM:
+            ret = set_completion_list_quantum(context, (quantum_params_t*)arg);
+            goto out;
+        case UMS_GET_STATS:
+            ret = get_stats(context, (stats_params_t*)arg);
             goto out;
         default:
             goto out;
 	}
 
     out:
-    printk(KERN_INFO UMS_MODULE_NAME_LOG "> IOCTL_END: pid: %d, tgid: %d, IOCTL:%d => return_value: %d\n",  current->pid, current->tgid, cmd, ret);
-    printk(KERN_INFO UMS_MODULE_NAME_LOG ">-----------------------------------------------------------\n",  current->pid, current->tgid, cmd, ret);
-    spin_unlock_irqrestore(&spinlock_ums, spinlock_flags_ums);
+    if(is_switch && ret == UMS_SUCCESS)
+    {
+        record_switch_latency(context, ktime_get_ns() - start);
+    }
+    host = READ_ONCE(context->host);
+    if(host != NULL && host->task == current)
+    {
+        host->in_ioctl = false;
+    }
+    trace_ums_ioctl_exit(cmd, ret);
 
 	return ret;
 }
 
+/** @brief The function that is called when UMS device is mapped
+ *.
+ *  Maps the counters of the process via @ref mmap_stats_page() if the offset is @c UMS_STATS_PAGE_PGOFF pages,
+ *  otherwise maps the ring of worker threads that became available of the completion list selected by the offset via @ref mmap_ready_ring()
+ *
+ *  @param file
+ *  @param vma memory area of the mapping
+ *  @return returns @c UMS_SUCCESS when succesful or error value in case of the failure
+ */
+static int mmap_ums(struct file *file, struct vm_area_struct *vma)
+{
+    if(vma->vm_pgoff == UMS_STATS_PAGE_PGOFF)
+    {
+        return mmap_stats_page(file->private_data, vma);
+    }
+    return mmap_ready_ring(file->private_data, vma);
+}
+
 /** @brief The function is responsible for initialization of the kernel module
  *.
  * 
@@ -125,10 +232,27 @@ static int __init init_dev(void)
     
     printk(KERN_INFO UMS_MODULE_NAME_LOG "> Initialization:\n");
 
+    ret = init_caches();
+    if (ret < 0)
+    {
+        printk(KERN_ERR UMS_MODULE_NAME_LOG "- Creation of slab caches has failed.\n");
+        return -UMS_ERROR;
+    }
+
+    ret = register_host_exit();
+    if (ret < 0)
+    {
+        printk(KERN_ERR UMS_MODULE_NAME_LOG "- Registration of the task exit notifier has failed, CONFIG_PROFILING is required.\n");
+        delete_caches();
+        return -UMS_ERROR;
+    }
+
     ret = misc_register(&dev_ums);
     if (ret < 0)
     {
         printk(KERN_ERR UMS_MODULE_NAME_LOG "- Registration of device " UMS_DEVICE " has failed.\n");
+        unregister_host_exit();
+        delete_caches();
         return -UMS_ERROR;
     }
 
@@ -138,9 +262,14 @@ static int __init init_dev(void)
     if (ret < 0)
     {
         printk(KERN_ERR UMS_MODULE_NAME_LOG "- Registration of proc filesystem of /proc/" UMS_NAME " has failed.\n");
+        misc_deregister(&dev_ums);
+        unregister_host_exit();
+        delete_caches();
         return -UMS_ERROR;
     }
 
+    preempt_notifier_inc();
+
     return UMS_SUCCESS;
 }
 
@@ -151,9 +280,12 @@ static int __init init_dev(void)
  */
 static void __exit exit_dev(void)
 {
+    preempt_notifier_dec();
     delete_proc();
     misc_deregister(&dev_ums);
+    unregister_host_exit();
     cleanup();
+    delete_caches();
     printk(KERN_INFO UMS_MODULE_NAME_LOG "> Shut down.\n");
 }
 
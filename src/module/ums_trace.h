@@ -0,0 +1,308 @@
+/**
+ * Copyright (C) 2021 Bektur Umarbaev <hrafnulf13@gmail.com>
+ *
+ * This file is part of the User Mode thread Scheduling (UMS) kernel module.
+ *
+ * UMS kernel module is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * UMS kernel module is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with UMS kernel module.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * @brief The header that contains tracepoints of the UMS kernel module
+ *
+ *  Tracepoints are defined in the @c ums trace system and can be consumed via ftrace (@c /sys/kernel/tracing/events/ums), perf or trace-cmd.
+ *  They cost a patched-out branch while disabled, thus they replace logging on the paths that are executed on every switch.
+ *  The tracepoints are instantiated in ums_dev.c, where @c CREATE_TRACE_POINTS is defined before including this header.
+ *
+ * @file ums_trace.h
+ * @author Bektur Umarbaev <hrafnulf13@gmail.com>
+ * @date
+ */
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM ums
+
+#if !defined(_UMS_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _UMS_TRACE_H
+
+#include "const.h"
+
+#include <linux/sched.h>
+#include <linux/tracepoint.h>
+
+/** @brief Traces the beginning of the ioctl call issued to UMS device
+ */
+TRACE_EVENT(ums_ioctl_enter,
+
+    TP_PROTO(unsigned int cmd),
+
+    TP_ARGS(cmd),
+
+    TP_STRUCT__entry(
+        __field(pid_t, pid)
+        __field(pid_t, tgid)
+        __field(unsigned int, cmd)
+    ),
+
+    TP_fast_assign(
+        __entry->pid = current->pid;
+        __entry->tgid = current->tgid;
+        __entry->cmd = cmd;
+    ),
+
+    TP_printk("pid=%d tgid=%d cmd=%u", __entry->pid, __entry->tgid, __entry->cmd)
+);
+
+/** @brief Traces the completion of the ioctl call issued to UMS device together with its' return value
+ */
+TRACE_EVENT(ums_ioctl_exit,
+
+    TP_PROTO(unsigned int cmd, long ret),
+
+    TP_ARGS(cmd, ret),
+
+    TP_STRUCT__entry(
+        __field(pid_t, pid)
+        __field(pid_t, tgid)
+        __field(unsigned int, cmd)
+        __field(long, ret)
+    ),
+
+    TP_fast_assign(
+        __entry->pid = current->pid;
+        __entry->tgid = current->tgid;
+        __entry->cmd = cmd;
+        __entry->ret = ret;
+    ),
+
+    TP_printk("pid=%d tgid=%d cmd=%u ret=%ld", __entry->pid, __entry->tgid, __entry->cmd, __entry->ret)
+);
+
+/** @brief Traces the process entering or exiting UMS, and the deletion of its' data structures
+ */
+DECLARE_EVENT_CLASS(ums_process_class,
+
+    TP_PROTO(pid_t pid),
+
+    TP_ARGS(pid),
+
+    TP_STRUCT__entry(
+        __field(pid_t, pid)
+    ),
+
+    TP_fast_assign(
+        __entry->pid = pid;
+    ),
+
+    TP_printk("pid=%d", __entry->pid)
+);
+
+DEFINE_EVENT(ums_process_class, ums_enter,
+    TP_PROTO(pid_t pid),
+    TP_ARGS(pid)
+);
+
+DEFINE_EVENT(ums_process_class, ums_exit,
+    TP_PROTO(pid_t pid),
+    TP_ARGS(pid)
+);
+
+DEFINE_EVENT(ums_process_class, ums_delete,
+    TP_PROTO(pid_t pid),
+    TP_ARGS(pid)
+);
+
+/** @brief Traces the creation of the completion list
+ */
+TRACE_EVENT(ums_create_list,
+
+    TP_PROTO(pid_t pid, ums_clid_t clid),
+
+    TP_ARGS(pid, clid),
+
+    TP_STRUCT__entry(
+        __field(pid_t, pid)
+        __field(ums_clid_t, clid)
+    ),
+
+    TP_fast_assign(
+        __entry->pid = pid;
+        __entry->clid = clid;
+    ),
+
+    TP_printk("pid=%d clid=%u", __entry->pid, __entry->clid)
+);
+
+/** @brief Traces the creation of the worker thread
+ */
+TRACE_EVENT(ums_create_worker,
+
+    TP_PROTO(pid_t pid, ums_wid_t wid, ums_clid_t clid),
+
+    TP_ARGS(pid, wid, clid),
+
+    TP_STRUCT__entry(
+        __field(pid_t, pid)
+        __field(ums_wid_t, wid)
+        __field(ums_clid_t, clid)
+    ),
+
+    TP_fast_assign(
+        __entry->pid = pid;
+        __entry->wid = wid;
+        __entry->clid = clid;
+    ),
+
+    TP_printk("pid=%d wid=%u clid=%u", __entry->pid, __entry->wid, __entry->clid)
+);
+
+/** @brief Traces the pthread entering or exiting scheduling mode
+ */
+DECLARE_EVENT_CLASS(ums_scheduler_class,
+
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_clid_t clid),
+
+    TP_ARGS(pid, sid, clid),
+
+    TP_STRUCT__entry(
+        __field(pid_t, pid)
+        __field(ums_sid_t, sid)
+        __field(ums_clid_t, clid)
+    ),
+
+    TP_fast_assign(
+        __entry->pid = pid;
+        __entry->sid = sid;
+        __entry->clid = clid;
+    ),
+
+    TP_printk("pid=%d sid=%u clid=%u", __entry->pid, __entry->sid, __entry->clid)
+);
+
+DEFINE_EVENT(ums_scheduler_class, ums_enter_scheduling_mode,
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_clid_t clid),
+    TP_ARGS(pid, sid, clid)
+);
+
+DEFINE_EVENT(ums_scheduler_class, ums_exit_scheduling_mode,
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_clid_t clid),
+    TP_ARGS(pid, sid, clid)
+);
+
+DEFINE_EVENT(ums_scheduler_class, ums_handoff,
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_clid_t clid),
+    TP_ARGS(pid, sid, clid)
+);
+
+/** @brief Traces the context switch between the scheduler and the worker thread
+ *.
+ *  @c state is the state of the worker thread after the switch
+ */
+DECLARE_EVENT_CLASS(ums_switch_class,
+
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_wid_t wid, ums_clid_t clid, state_t state),
+
+    TP_ARGS(pid, sid, wid, clid, state),
+
+    TP_STRUCT__entry(
+        __field(pid_t, pid)
+        __field(ums_sid_t, sid)
+        __field(ums_wid_t, wid)
+        __field(ums_clid_t, clid)
+        __field(int, state)
+    ),
+
+    TP_fast_assign(
+        __entry->pid = pid;
+        __entry->sid = sid;
+        __entry->wid = wid;
+        __entry->clid = clid;
+        __entry->state = state;
+    ),
+
+    TP_printk("pid=%d sid=%u wid=%u clid=%u state=%s", __entry->pid, __entry->sid, __entry->wid, __entry->clid,
+        __print_symbolic(__entry->state, { IDLE, "IDLE" }, { RUNNING, "RUNNING" }, { FINISHED, "FINISHED" }))
+);
+
+DEFINE_EVENT(ums_switch_class, ums_execute,
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_wid_t wid, ums_clid_t clid, state_t state),
+    TP_ARGS(pid, sid, wid, clid, state)
+);
+
+DEFINE_EVENT(ums_switch_class, ums_yield,
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_wid_t wid, ums_clid_t clid, state_t state),
+    TP_ARGS(pid, sid, wid, clid, state)
+);
+
+DEFINE_EVENT(ums_switch_class, ums_block,
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_wid_t wid, ums_clid_t clid, state_t state),
+    TP_ARGS(pid, sid, wid, clid, state)
+);
+
+DEFINE_EVENT(ums_switch_class, ums_preempt,
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_wid_t wid, ums_clid_t clid, state_t state),
+    TP_ARGS(pid, sid, wid, clid, state)
+);
+
+/** @brief Traces the retrieval of available worker threads from the completion list
+ *.
+ *  @c state is the state of the completion list reported to the scheduler
+ */
+DECLARE_EVENT_CLASS(ums_dequeue_class,
+
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_clid_t clid, unsigned int count, state_t state),
+
+    TP_ARGS(pid, sid, clid, count, state),
+
+    TP_STRUCT__entry(
+        __field(pid_t, pid)
+        __field(ums_sid_t, sid)
+        __field(ums_clid_t, clid)
+        __field(unsigned int, count)
+        __field(int, state)
+    ),
+
+    TP_fast_assign(
+        __entry->pid = pid;
+        __entry->sid = sid;
+        __entry->clid = clid;
+        __entry->count = count;
+        __entry->state = state;
+    ),
+
+    TP_printk("pid=%d sid=%u clid=%u count=%u state=%s", __entry->pid, __entry->sid, __entry->clid, __entry->count,
+        __print_symbolic(__entry->state, { IDLE, "IDLE" }, { RUNNING, "RUNNING" }, { FINISHED, "FINISHED" }))
+);
+
+DEFINE_EVENT(ums_dequeue_class, ums_dequeue,
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_clid_t clid, unsigned int count, state_t state),
+    TP_ARGS(pid, sid, clid, count, state)
+);
+
+/** @brief Traces the migration of idle worker threads of another completion list to the completion list of the scheduler by work stealing
+ *.
+ *  @c clid is the completion list the worker threads were moved to
+ */
+DEFINE_EVENT(ums_dequeue_class, ums_steal,
+    TP_PROTO(pid_t pid, ums_sid_t sid, ums_clid_t clid, unsigned int count, state_t state),
+    TP_ARGS(pid, sid, clid, count, state)
+);
+
+#endif /* _UMS_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE ums_trace
+
+#include <trace/define_trace.h>
@@ -7,13 +7,13 @@ void loop1()
     printf("- UMS_EXAMPLE_%s\n", __FUNCTION__);
     
 
-    list_params_t *ready_list = ums_dequeue_completion_list_items();
+    list_params_t *ready_list = ums_dequeue_completion_list_items_wait(UMS_WAIT_INFINITE);
     ums_wid_t worker_id = ums_get_next_worker_thread(ready_list);
     while(ready_list->state != FINISHED)
     {
         printf("-- UMS_EXAMPLE_LOOP: Worker = %d\n", (int)worker_id);
         ums_execute_thread(worker_id);
-        ready_list = ums_dequeue_completion_list_items();
+        ready_list = ums_dequeue_completion_list_items_wait(UMS_WAIT_INFINITE);
         worker_id = ums_get_next_worker_thread(ready_list);
     }
 
@@ -23,7 +23,7 @@ void loop1()
 void loop2()
 {
     printf("- UMS_EXAMPLE_%s\n", __FUNCTION__);
-    list_params_t *ready_list = ums_dequeue_completion_list_items();
+    list_params_t *ready_list = ums_dequeue_completion_list_items_wait(UMS_WAIT_INFINITE);
     ums_wid_t worker_id = ums_get_next_worker_thread(ready_list);
     printf("-- UMS_EXAMPLE_LOOP: Worker = %d\n", (int)worker_id);
     ums_execute_thread(worker_id);
@@ -0,0 +1,107 @@
+#include "ums_lib.h"
+#include <stdlib.h>
+
+#define STACK_SIZE 65536
+#define WORKER_COUNT 4
+#define QUANTUM 100000
+#define ITERATIONS 2000000000UL
+#define RAX_VALUE 0x5555aaaa5555aaaaUL
+
+/*
+ * Checks that a worker thread preempted at an arbitrary instruction is resumed with its' registers:
+ * each worker thread keeps a live value in rax while it spins for many time quanta, then compares it.
+ * The worker thread is preempted in the handler of UMS_PREEMPT_SIGNAL, thus its' stack has to fit a signal frame.
+ */
+int failures = 0;
+unsigned long long preemptions = 0;
+ums_wid_t worker_ids[WORKER_COUNT];
+
+void loop()
+{
+    printf("---- UMS_EXAMPLE_%s\n", __FUNCTION__);
+
+    list_params_t *ready_list = ums_dequeue_completion_list_items_wait(UMS_WAIT_INFINITE);
+    ums_wid_t worker_id = ums_get_next_worker_thread(ready_list);
+    while(ready_list->state != FINISHED)
+    {
+        ums_execute_thread(worker_id);
+        ready_list = ums_dequeue_completion_list_items_wait(UMS_WAIT_INFINITE);
+        worker_id = ums_get_next_worker_thread(ready_list);
+    }
+
+    ums_exit_scheduling_mode();
+}
+
+unsigned long spin_with_live_rax(unsigned long value, unsigned long iterations)
+{
+    unsigned long result;
+
+    asm volatile(
+        "mov %[value], %%rax\n"
+        "1:\n"
+        "dec %[count]\n"
+        "jnz 1b\n"
+        "mov %%rax, %[result]\n"
+        : [result] "=r" (result), [count] "+r" (iterations)
+        : [value] "r" (value)
+        : "rax", "cc");
+
+    return result;
+}
+
+unsigned long long get_quantum_expirations(ums_wid_t wid)
+{
+    unsigned long long expirations = 0;
+    stats_params_t *stats = ums_get_stats(NULL);
+    if(stats == NULL)
+    {
+        return 0;
+    }
+
+    for(unsigned int i = 0; i < stats->entry_count; ++i)
+    {
+        if(stats->entries[i].type == WORKER_STATS && stats->entries[i].worker.wid == wid)
+        {
+            expirations = stats->entries[i].worker.quantum_expirations;
+        }
+    }
+    free(stats);
+    return expirations;
+}
+
+void function(void *args)
+{
+    unsigned long value = RAX_VALUE + *(int*)args;
+    unsigned long result = spin_with_live_rax(value, ITERATIONS);
+
+    __atomic_add_fetch(&preemptions, get_quantum_expirations(worker_ids[*(int*)args]), __ATOMIC_RELAXED);
+
+    if(result != value)
+    {
+        printf("---- UMS_EXAMPLE: Worker %d: rax = %lx, expected %lx\n", *(int*)args, result, value);
+        __atomic_add_fetch(&failures, 1, __ATOMIC_RELAXED);
+    }
+    ums_thread_exit();
+}
+
+int main()
+{
+    int args[WORKER_COUNT];
+
+    ums_enter();
+    ums_clid_t comp_list = ums_create_completion_list();
+    ums_set_completion_list_quantum(comp_list, QUANTUM);
+
+    for(int i = 0; i < WORKER_COUNT; ++i)
+    {
+        args[i] = i;
+        worker_ids[i] = ums_create_worker_thread(comp_list, STACK_SIZE, function, &args[i]);
+    }
+
+    ums_sid_t scheduler1 = ums_create_scheduler(comp_list, loop);
+
+    ums_exit();
+
+    printf("---- UMS_EXAMPLE: %d of %d worker threads lost rax, %llu preemptions\n", failures, WORKER_COUNT, preemptions);
+    return failures != 0;
+}